@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures the scheduling latency of latency sensitive work while the pool is
+// saturated with background work, once submitted at high priority and once
+// at low priority, which behaves like a plain FIFO pool.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <emplace_from.hpp>
+#include <optional>
+#include <priority_thread_pool.hpp>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+using execution::priority;
+using execution::priority_thread_pool;
+
+struct priority_env {
+  priority value;
+
+  friend auto tag_invoke(functional::tag_t<execution::get_priority> /*unused*/,
+                         priority_env const& env) noexcept -> priority {
+    return env.value;
+  }
+};
+
+void busy_for(std::chrono::microseconds duration) {
+  auto const end = clock_type::now() + duration;
+  while (clock_type::now() < end) {
+  }
+}
+
+// Background job that reschedules itself at low priority until stopped.
+struct background_job {
+  struct receiver {
+    background_job* job;
+
+    friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                           receiver&& r) noexcept {
+      auto* job = r.job;  // r dies with the operation in restart().
+      busy_for(std::chrono::microseconds(20));
+      if (!job->stop->load(std::memory_order_relaxed)) {
+        job->restart();
+      } else {
+        job->done.store(true, std::memory_order_release);
+      }
+    }
+
+    friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                           receiver const& /*unused*/) noexcept
+        -> priority_env {
+      return {priority::low};
+    }
+  };
+
+  using operation = execution::connect_result_t<
+      execution::schedule_result_t<priority_thread_pool::scheduler>, receiver>;
+
+  priority_thread_pool* pool;
+  std::atomic<bool>* stop;
+  std::atomic<bool> done{false};
+  std::optional<operation> op;
+
+  void restart() {
+    op.emplace(execution::emplace_from{[this] {
+      return execution::connect(execution::schedule(pool->get_scheduler()),
+                                receiver{this});
+    }});
+    execution::start(*op);
+  }
+};
+
+struct probe_receiver {
+  clock_type::time_point submitted;
+  priority prio;
+  std::atomic<clock_type::duration::rep>* latency;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         probe_receiver&& r) noexcept {
+    r.latency->store((clock_type::now() - r.submitted).count(),
+                     std::memory_order_release);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         probe_receiver const& r) noexcept -> priority_env {
+    return {r.prio};
+  }
+};
+
+auto percentile(std::vector<double>& samples, double p) -> double {
+  std::sort(samples.begin(), samples.end());
+  auto const index = static_cast<std::size_t>(
+      p * static_cast<double>(samples.size() - 1));
+  return samples[index];
+}
+
+void measure(priority prio, const char* label) {
+  constexpr std::size_t probes = 2000;
+  auto const threads =
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  priority_thread_pool pool{threads};
+
+  std::atomic<bool> stop{false};
+  std::deque<background_job> jobs;
+  for (std::size_t i = 0; i < 4 * threads; ++i) {
+    jobs.emplace_back(&pool, &stop);
+    jobs.back().restart();
+  }
+
+  std::vector<double> samples;
+  samples.reserve(probes);
+  for (std::size_t i = 0; i < probes; ++i) {
+    std::atomic<clock_type::duration::rep> latency{-1};
+    auto op =
+        execution::connect(execution::schedule(pool.get_scheduler()),
+                           probe_receiver{clock_type::now(), prio, &latency});
+    execution::start(op);
+    while (latency.load(std::memory_order_acquire) < 0) {
+      std::this_thread::yield();
+    }
+    samples.push_back(std::chrono::duration<double, std::micro>(
+                          clock_type::duration{latency.load()})
+                          .count());
+  }
+
+  stop.store(true);
+  for (auto& job : jobs) {
+    while (!job.done.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto const p50 = percentile(samples, 0.50);
+  auto const p99 = percentile(samples, 0.99);
+  std::printf("%-14s p50 %10.1f us   p99 %10.1f us   max %10.1f us\n", label,
+              p50, p99, samples.back());
+}
+
+}  // namespace
+
+auto main() -> int {
+  measure(priority::high, "high priority");
+  measure(priority::low, "low priority");
+}
@@ -0,0 +1,173 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures the per-iteration cost of repeat_effect_until over an effect that
+// completes inline on a trampoline_scheduler, with and without a stoppable
+// token in the environment, against a plain loop and against an effect that
+// hops to a thread pool. Also reports heap allocations per iteration.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <environment.hpp>
+#include <exception>
+#include <get_stop_token.hpp>
+#include <in_place_stop_token.hpp>
+#include <new>
+#include <priority_thread_pool.hpp>
+#include <repeat.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <then.hpp>
+#include <thread>
+#include <trampoline_scheduler.hpp>
+
+namespace {
+
+std::atomic<std::size_t> allocations{0};
+
+}  // namespace
+
+auto operator new(std::size_t size) -> void* {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size)) {  // NOLINT
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }  // NOLINT
+
+void operator delete(void* p, std::size_t /*unused*/) noexcept {
+  std::free(p);  // NOLINT
+}
+
+namespace {
+
+struct stop_env {
+  execution::in_place_stop_token token;
+
+  friend auto tag_invoke(
+      functional::tag_t<execution::get_stop_token> /*unused*/,
+      stop_env const& env) noexcept -> execution::in_place_stop_token {
+    return env.token;
+  }
+};
+
+template <class Env>
+struct done_receiver {
+  std::atomic<bool>* done;
+  Env env;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         done_receiver&& r) noexcept {
+    r.done->store(true, std::memory_order_release);
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_error> /*unused*/,
+                         done_receiver&& /*unused*/,
+                         std::exception_ptr /*unused*/) noexcept {
+    std::abort();
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_stopped> /*unused*/,
+                         done_receiver&& /*unused*/) noexcept {
+    std::abort();
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         done_receiver const& r) noexcept -> Env {
+    return r.env;
+  }
+};
+
+struct result {
+  double ns_per_iteration;
+  double allocations_per_iteration;
+};
+
+template <class Scheduler, class Env>
+auto measure(Scheduler scheduler, Env env, std::size_t iterations) -> result {
+  std::size_t count = 0;
+  std::atomic<bool> done{false};
+  auto op = execution::connect(
+      execution::repeat_effect_until(
+          execution::then(execution::schedule(scheduler),
+                          [&count]() noexcept { ++count; }),
+          [&count, iterations]() noexcept { return count == iterations; }),
+      done_receiver<Env>{&done, env});
+
+  auto const allocated = allocations.load();
+  auto const start = std::chrono::steady_clock::now();
+  execution::start(op);
+  while (!done.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  auto const n = static_cast<double>(iterations);
+  return {std::chrono::duration<double, std::nano>(elapsed).count() / n,
+          static_cast<double>(allocations.load() - allocated) / n};
+}
+
+auto measure_loop(std::size_t iterations) -> result {
+  std::size_t count = 0;
+  auto const start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) {
+    ++count;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+  }
+  auto const elapsed = std::chrono::steady_clock::now() - start;
+  return {std::chrono::duration<double, std::nano>(elapsed).count() /
+              static_cast<double>(count),
+          0.0};
+}
+
+void print(char const* name, result r) {
+  std::printf("%-34s %12.2f %14.3f\n", name, r.ns_per_iteration,
+              r.allocations_per_iteration);
+}
+
+}  // namespace
+
+auto main() -> int {
+  constexpr std::size_t iterations = 10'000'000;
+  constexpr std::size_t pool_iterations = 100'000;
+
+  std::printf("%-34s %12s %14s\n", "effect", "ns/iter", "allocs/iter");
+  print("plain loop", measure_loop(iterations));
+  print("trampoline", measure(execution::trampoline_scheduler{},
+                              execution::empty_env{}, iterations));
+
+  execution::in_place_stop_source source;
+  print("trampoline, stoppable env",
+        measure(execution::trampoline_scheduler{},
+                stop_env{source.get_token()}, iterations));
+
+  execution::priority_thread_pool pool{1};
+  print("priority_thread_pool", measure(pool.get_scheduler(),
+                                        execution::empty_env{},
+                                        pool_iterations));
+}
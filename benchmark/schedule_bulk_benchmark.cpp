@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures the submission cost per task of starting a batch of scheduled
+// operations one start() at a time versus with one schedule_bulk call, for
+// batch sizes from 1 to 10k, on both thread pools.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <emplace_from.hpp>
+#include <environment.hpp>
+#include <pinned_thread_pool.hpp>
+#include <priority_thread_pool.hpp>
+#include <schedule_bulk.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <thread>
+
+namespace {
+
+struct counting_receiver {
+  std::atomic<std::size_t>* count;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         counting_receiver&& r) noexcept {
+    r.count->fetch_add(1, std::memory_order_release);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         counting_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+// Best submission time per task over several repetitions. Each repetition
+// waits for the batch to finish, so queues start out empty.
+template <class Scheduler, class Submit>
+auto measure(Scheduler sched, std::size_t batchSize, Submit submit)
+    -> double {
+  using operation = execution::connect_result_t<
+      execution::schedule_result_t<Scheduler>, counting_receiver>;
+  constexpr int repetitions = 20;
+  auto best = std::chrono::steady_clock::duration::max();
+  for (int r = 0; r < repetitions; ++r) {
+    std::atomic<std::size_t> count{0};
+    std::deque<operation> ops;
+    for (std::size_t i = 0; i < batchSize; ++i) {
+      ops.emplace_back(execution::emplace_from{[&] {
+        return execution::connect(execution::schedule(sched),
+                                  counting_receiver{&count});
+      }});
+    }
+    auto const start = std::chrono::steady_clock::now();
+    submit(sched, ops);
+    best = std::min(best, std::chrono::steady_clock::now() - start);
+    while (count.load(std::memory_order_acquire) != batchSize) {
+      std::this_thread::yield();
+    }
+  }
+  return std::chrono::duration<double, std::nano>(best).count() /
+         static_cast<double>(batchSize);
+}
+
+template <class Scheduler>
+void run(char const* name, Scheduler sched) {
+  for (std::size_t batchSize = 1; batchSize <= 10'000; batchSize *= 10) {
+    auto const each = measure(sched, batchSize, [](auto, auto& ops) {
+      for (auto& op : ops) {
+        execution::start(op);
+      }
+    });
+    auto const bulk = measure(sched, batchSize, [](auto s, auto& ops) {
+      execution::schedule_bulk(s, ops);
+    });
+    std::printf("%-22s %8zu %14.1f %14.1f\n", name, batchSize, each, bulk);
+  }
+}
+
+}  // namespace
+
+auto main() -> int {
+  auto const threads =
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  std::printf("%-22s %8s %14s %14s (%zu threads)\n", "pool", "batch",
+              "start ns/task", "bulk ns/task", threads);
+
+  execution::priority_thread_pool priority_pool{threads};
+  run("priority_thread_pool", priority_pool.get_scheduler());
+
+  execution::pinned_thread_pool pinned_pool;
+  run("pinned_thread_pool", pinned_pool.get_scheduler());
+}
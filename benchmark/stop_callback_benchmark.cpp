@@ -0,0 +1,144 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// Measures how long request_stop() takes to run N registered callbacks,
+// serially, in batches on the requesting thread, and in batches spread over
+// several threads.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <in_place_stop_token.hpp>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Stands in for the work an operation does when cancelled.
+struct cancel_work {
+  std::uint64_t* out;
+  void operator()() const noexcept {
+    auto x = reinterpret_cast<std::uintptr_t>(out);  // NOLINT
+    for (int i = 0; i < 64; ++i) {
+      x ^= x << 13U;
+      x ^= x >> 7U;
+      x ^= x << 17U;
+    }
+    *out = x;
+  }
+};
+
+using callback = execution::in_place_stop_callback<cancel_work>;
+
+// Threads started up front that invoke the runners handed to them, so that
+// the parallel measurement does not include thread startup.
+class runner_threads {
+ public:
+  explicit runner_threads(std::size_t count) {
+    threads_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      threads_.emplace_back([this](std::stop_token stop) { run(stop); });
+    }
+  }
+
+  void submit(execution::in_place_stop_runner runner) {
+    {
+      std::lock_guard lock{mutex_};
+      runners_.push_back(std::move(runner));
+    }
+    ready_.notify_one();
+  }
+
+ private:
+  void run(std::stop_token const& stop) {
+    while (true) {
+      std::unique_lock lock{mutex_};
+      if (!ready_.wait(lock, stop, [&] { return !runners_.empty(); })) {
+        return;
+      }
+      auto runner = std::move(runners_.front());
+      runners_.pop_front();
+      lock.unlock();
+      runner();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable_any ready_;
+  std::deque<execution::in_place_stop_runner> runners_;
+  // Last, so that the threads are stopped and joined first.
+  std::vector<std::jthread> threads_;
+};
+
+template <typename RequestStop>
+auto measure(std::size_t count, RequestStop request_stop) -> double {
+  constexpr int repetitions = 5;
+  auto best = std::chrono::steady_clock::duration::max();
+  std::vector<std::uint64_t> results(count);
+  for (int r = 0; r < repetitions; ++r) {
+    execution::in_place_stop_source source;
+    std::deque<callback> callbacks;
+    for (std::size_t i = 0; i < count; ++i) {
+      callbacks.emplace_back(source.get_token(), cancel_work{&results[i]});
+    }
+    auto const start = std::chrono::steady_clock::now();
+    request_stop(source);
+    best = std::min(best, std::chrono::steady_clock::now() - start);
+  }
+  return std::chrono::duration<double, std::micro>(best).count();
+}
+
+}  // namespace
+
+auto main() -> int {
+  auto const threads =
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  runner_threads helpers{threads - 1};
+  std::printf("%10s %14s %14s %14s (%zu threads)\n", "callbacks", "serial us",
+              "batched us", "parallel us", threads);
+  for (std::size_t count = 10; count <= 100'000; count *= 10) {
+    auto const serial = measure(count, [](auto& source) {
+      source.request_stop();
+    });
+    auto const batched = measure(count, [](auto& source) {
+      source.request_stop(execution::in_place_stop_batching{});
+    });
+    auto const parallel = measure(count, [&](auto& source) {
+      source.request_stop(
+          execution::in_place_stop_batching{256, threads},
+          [&](execution::in_place_stop_runner runner) {
+            helpers.submit(std::move(runner));
+          });
+    });
+    std::printf("%10zu %14.1f %14.1f %14.1f\n", count, serial, batched,
+                parallel);
+  }
+}
@@ -0,0 +1,194 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace execution {
+
+// Parses a Linux CPU list such as "0-3,8,10-11". Malformed entries are
+// skipped.
+inline auto parse_cpu_list(std::string_view list) -> std::vector<std::size_t> {
+  std::vector<std::size_t> cpus;
+  auto parse_number = [](std::string_view str, std::size_t& value) {
+    auto const* last = str.data() + str.size();  // NOLINT
+    auto [ptr, ec] = std::from_chars(str.data(), last, value);
+    return ec == std::errc{} && ptr == last;
+  };
+  while (!list.empty()) {
+    auto const comma = list.find(',');
+    auto entry = list.substr(0, comma);
+    list = comma == std::string_view::npos ? std::string_view{}
+                                           : list.substr(comma + 1);
+    auto const begin = entry.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos) {
+      continue;
+    }
+    entry = entry.substr(begin,
+                         entry.find_last_not_of(" \t\r\n") + 1 - begin);
+    auto const dash = entry.find('-');
+    std::size_t first = 0;
+    std::size_t last = 0;
+    if (dash == std::string_view::npos) {
+      if (!parse_number(entry, first)) {
+        continue;
+      }
+      last = first;
+    } else if (!parse_number(entry.substr(0, dash), first) ||
+               !parse_number(entry.substr(dash + 1), last) || last < first) {
+      continue;
+    }
+    for (auto cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// CPUs the calling thread is allowed to run on. Falls back to
+// [0, hardware_concurrency) where affinity is not supported.
+inline auto available_cpus() -> std::vector<std::size_t> {
+  std::vector<std::size_t> cpus;
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    auto const count = std::max(std::thread::hardware_concurrency(), 1U);
+    for (std::size_t cpu = 0; cpu < count; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+// Restricts the calling thread to cpu. Returns false if the platform does
+// not support affinity or the CPU is not available to this process.
+inline auto pin_current_thread(std::size_t cpu) noexcept -> bool {
+#if defined(__linux__)
+  if (cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+// NUMA nodes of the machine, each with the CPUs that belong to it. Nodes are
+// numbered densely in the order they were found.
+class cpu_topology {
+ public:
+  explicit cpu_topology(std::vector<std::vector<std::size_t>> nodes)
+      : nodes_(std::move(nodes)) {
+    if (nodes_.empty()) {
+      nodes_.emplace_back();
+    }
+  }
+
+  // Reads the nodes from /sys/devices/system/node. Without that directory,
+  // or on other platforms, all CPUs form a single node.
+  static auto detect() -> cpu_topology {
+    namespace fs = std::filesystem;
+    std::vector<std::pair<std::size_t, std::vector<std::size_t>>> found;
+    std::error_code ec;
+    fs::directory_iterator it{"/sys/devices/system/node", ec};
+    for (; !ec && it != fs::directory_iterator{}; it.increment(ec)) {
+      auto const name = it->path().filename().string();
+      std::size_t id = 0;
+      if (!name.starts_with("node") ||
+          std::from_chars(name.data() + 4, name.data() + name.size(), id)
+                  .ec != std::errc{}) {  // NOLINT
+        continue;
+      }
+      std::ifstream file{it->path() / "cpulist"};
+      std::string list;
+      if (std::getline(file, list)) {
+        found.emplace_back(id, parse_cpu_list(list));
+      }
+    }
+    std::sort(found.begin(), found.end());
+
+    std::vector<std::vector<std::size_t>> nodes;
+    for (auto& node : found) {
+      if (!node.second.empty()) {
+        nodes.push_back(std::move(node.second));
+      }
+    }
+    if (nodes.empty()) {
+      nodes.push_back(available_cpus());
+    }
+    return cpu_topology{std::move(nodes)};
+  }
+
+  [[nodiscard]] auto node_count() const noexcept -> std::size_t {
+    return nodes_.size();
+  }
+
+  [[nodiscard]] auto cpus_of(std::size_t node) const
+      -> std::vector<std::size_t> const& {
+    return nodes_.at(node);
+  }
+
+  // Node holding cpu. CPUs unknown to the topology map to node 0.
+  [[nodiscard]] auto node_of(std::size_t cpu) const noexcept -> std::size_t {
+    for (std::size_t node = 0; node < nodes_.size(); ++node) {
+      if (std::find(nodes_[node].begin(), nodes_[node].end(), cpu) !=
+          nodes_[node].end()) {
+        return node;
+      }
+    }
+    return 0;
+  }
+
+ private:
+  std::vector<std::vector<std::size_t>> nodes_;
+};
+
+}  // namespace execution
@@ -34,6 +34,8 @@ struct no_env {
   friend void tag_invoke(auto, std::same_as<no_env> auto, auto&&...) = delete;
 };
 
+struct empty_env {};
+
 namespace _get_env {
 
 struct get_env_t {
@@ -56,7 +58,7 @@ namespace _forwarding_env_query {
 struct forwarding_env_query_t {
   template <typename Query>
   requires functional::tag_invocable<forwarding_env_query_t, Query const&>
-  auto operator()(Query const& query) const noexcept(
+  constexpr auto operator()(Query const& query) const noexcept(
       functional::nothrow_tag_invocable<forwarding_env_query_t, Query const&>)
       -> functional::tag_invoke_result_t<forwarding_env_query_t, Query const&> {
     using result_t =
@@ -77,4 +79,38 @@ concept environment_provier = requires(EnvProvier& ep) {
   { get_env(std::as_const(ep)) } -> tf::none_of<void, no_env>;
 };
 
+template <typename Query>
+concept forwarding_query = std::default_initializable<Query> &&
+    functional::tag_invocable<_forwarding_env_query::forwarding_env_query_t,
+                              Query const&> &&
+    (forwarding_env_query(Query{}));
+
+// Answers exactly the forwarding queries of Env. Receiver adaptors return it
+// from get_env, so properties like priority or tracer carry along a chain.
+template <typename Env>
+class forwarding_env {
+ public:
+  explicit forwarding_env(Env env) noexcept(
+      std::is_nothrow_move_constructible_v<Env>)
+      : env_(std::move(env)) {}
+
+  template <forwarding_query Query, typename... Args>
+  requires functional::tag_invocable<Query, Env const&, Args...>
+  friend auto tag_invoke(Query query, forwarding_env const& self,
+                         Args&&... args) noexcept(
+      functional::nothrow_tag_invocable<Query, Env const&, Args...>)
+      -> functional::tag_invoke_result_t<Query, Env const&, Args...> {
+    return functional::tag_invoke(query, self.env_,
+                                  std::forward<Args>(args)...);
+  }
+
+ private:
+  Env env_;
+};
+
+template <typename Env>
+auto forward_env(Env&& env) -> forwarding_env<std::remove_cvref_t<Env>> {
+  return forwarding_env<std::remove_cvref_t<Env>>{std::forward<Env>(env)};
+}
+
 }  // namespace execution
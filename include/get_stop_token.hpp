@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <environment.hpp>
+#include <never_stop_token.hpp>
+#include <stop_token_concepts.hpp>
+#include <tag_invoke.hpp>
+#include <utility>
+
+namespace execution {
+
+namespace _get_stop_token {
+
+struct get_stop_token_t {
+  template <class Env>
+  requires functional::tag_invocable<get_stop_token_t, Env const&>
+  auto operator()(Env const& env) const noexcept
+      -> functional::tag_invoke_result_t<get_stop_token_t, Env const&> {
+    using result_t =
+        functional::tag_invoke_result_t<get_stop_token_t, Env const&>;
+    static_assert(
+        functional::nothrow_tag_invocable<get_stop_token_t, Env const&>);
+    static_assert(stoppable_token<result_t>);
+    return tag_invoke(*this, env);
+  }
+
+  // Environments without a stop token can never be stopped.
+  template <class Env>
+  constexpr auto operator()(Env const& /*unused*/) const noexcept
+      -> never_stop_token {
+    return {};
+  }
+
+  friend constexpr auto tag_invoke(
+      functional::tag_t<forwarding_env_query> /*unused*/,
+      get_stop_token_t /*unused*/) noexcept -> bool {
+    return true;
+  }
+};
+
+}  // namespace _get_stop_token
+
+inline constexpr _get_stop_token::get_stop_token_t get_stop_token{};
+
+template <class Env>
+using stop_token_of_t = decltype(get_stop_token(std::declval<Env const&>()));
+
+}  // namespace execution
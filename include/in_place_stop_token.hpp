@@ -16,20 +16,34 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <cassert>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <new>
 #include <spin_wait.hpp>
+#include <stop_metrics.hpp>
 #include <thread>
 #include <type_traits>
+#include <utility>
 
 namespace execution {
 
 class in_place_stop_source;
 class in_place_stop_token;
+class in_place_stop_runner;
 template <typename F>
 class in_place_stop_callback;
 
+namespace detail {
+class in_place_stop_batch;
+class in_place_stop_runners;
+}  // namespace detail
+
 class in_place_stop_callback_base {
  public:
   void execute() noexcept { this->execute_(this); }
@@ -44,6 +58,7 @@ class in_place_stop_callback_base {
   void register_callback() noexcept;
 
   friend in_place_stop_source;
+  friend detail::in_place_stop_batch;
 
   in_place_stop_source* source_;                     // NOLINT
   execute_fn* execute_;                              // NOLINT
@@ -51,6 +66,17 @@ class in_place_stop_callback_base {
   in_place_stop_callback_base** prevPtr_ = nullptr;  // NOLINT
   bool* removedDuringCallback_ = nullptr;            // NOLINT
   std::atomic<bool> callbackCompleted_{false};       // NOLINT
+  // Entry in the batch of a runner, while it is pending there.
+  std::atomic<std::atomic<in_place_stop_callback_base*>*> slot_{  // NOLINT
+      nullptr};
+};
+
+// Controls how request_stop() runs a large list of callbacks. Callbacks are
+// taken off the list batch_size at a time under a single lock hold, and up
+// to parallelism runners (the requesting thread included) execute batches.
+struct in_place_stop_batching {
+  std::size_t batch_size = 64;
+  std::size_t parallelism = 1;
 };
 
 class in_place_stop_source {
@@ -66,6 +92,24 @@ class in_place_stop_source {
 
   auto request_stop() noexcept -> bool;
 
+  // Like request_stop(), but executes callbacks in batches on the calling
+  // thread.
+  auto request_stop(in_place_stop_batching options) noexcept -> bool;
+
+  // Like request_stop(), but additionally passes options.parallelism - 1
+  // runners to spawn, which should hand them to other threads, e.g. as tasks
+  // on a thread pool. Once the calling thread ran out of callbacks, runners
+  // that have not started yet are abandoned: invoking them later does
+  // nothing, and they may also be destroyed without being invoked. Returns
+  // only after the runners that did start finished, so that every callback
+  // has completed by then. Destroying a callback that sits in the batch of
+  // another runner drops it from there; only a callback that is executing is
+  // waited for.
+  template <typename Spawn>
+  requires std::invocable<Spawn&, in_place_stop_runner>
+  auto request_stop(in_place_stop_batching options, Spawn&& spawn) noexcept
+      -> bool;
+
   auto get_token() noexcept -> in_place_stop_token;
 
   [[nodiscard]] auto stop_requested() const noexcept -> bool {
@@ -75,9 +119,12 @@ class in_place_stop_source {
  private:
   friend in_place_stop_token;
   friend in_place_stop_callback_base;
+  friend in_place_stop_runner;
   template <typename F>
   friend class in_place_stop_callback;
 
+  void run_callback_batches(std::size_t batchSize) noexcept;
+
   auto lock() noexcept -> std::uint8_t;
   void unlock(std::uint8_t oldState) noexcept;
 
@@ -95,6 +142,259 @@ class in_place_stop_source {
   std::thread::id notifyingThreadId_;
 };
 
+namespace detail {
+
+// Shared by a parallel request_stop() and the runners it spawned. Allocated
+// on the heap and reference counted, as a runner may be invoked or
+// destroyed after request_stop() returned and the source is gone.
+class in_place_stop_runners {
+ public:
+  in_place_stop_runners() noexcept = default;
+
+  in_place_stop_runners(const in_place_stop_runners&) = delete;
+  in_place_stop_runners(in_place_stop_runners&&) = delete;
+  auto operator=(const in_place_stop_runners&)
+      -> in_place_stop_runners& = delete;
+  auto operator=(in_place_stop_runners&&) -> in_place_stop_runners& = delete;
+
+  ~in_place_stop_runners() = default;
+
+  void add_ref() noexcept { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  void release() noexcept {
+    if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  // A runner may touch the source only if this returns true, and must call
+  // finish_claim() when done with it.
+  auto try_claim() noexcept -> bool {
+    auto claims = claims_.load(std::memory_order_relaxed);
+    do {
+      if ((claims & closed) != 0) {
+        return false;
+      }
+    } while (!claims_.compare_exchange_weak(claims, claims + 1,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed));
+    return true;
+  }
+
+  void finish_claim() noexcept {
+    // The source may be gone as soon as this is observed.
+    claims_.fetch_sub(1, std::memory_order_release);
+  }
+
+  // Abandons runners that have not claimed yet and waits for the others.
+  void close_and_wait() noexcept {
+    claims_.fetch_or(closed, std::memory_order_relaxed);
+    spin_wait spin;
+    while ((claims_.load(std::memory_order_acquire) & ~closed) != 0) {
+      spin.wait();
+    }
+  }
+
+ private:
+  static constexpr std::size_t closed = ~(~std::size_t{0} >> 1U);
+
+  std::atomic<std::size_t> claims_{0};
+  std::atomic<std::size_t> refs_{1};
+};
+
+}  // namespace detail
+
+// Executes batches of callbacks of a source whose stop was requested, until
+// none are left. Does nothing if the requesting thread has already finished.
+class in_place_stop_runner {
+ public:
+  in_place_stop_runner(const in_place_stop_runner&) = delete;
+  auto operator=(const in_place_stop_runner&)
+      -> in_place_stop_runner& = delete;
+
+  in_place_stop_runner(in_place_stop_runner&& other) noexcept
+      : source_(other.source_),
+        batchSize_(other.batchSize_),
+        shared_(std::exchange(other.shared_, nullptr)) {}
+
+  auto operator=(in_place_stop_runner&& other) noexcept
+      -> in_place_stop_runner& {
+    if (this != &other) {
+      if (shared_ != nullptr) {
+        shared_->release();
+      }
+      source_ = other.source_;
+      batchSize_ = other.batchSize_;
+      shared_ = std::exchange(other.shared_, nullptr);
+    }
+    return *this;
+  }
+
+  ~in_place_stop_runner() {
+    if (shared_ != nullptr) {
+      shared_->release();
+    }
+  }
+
+  void operator()() noexcept {
+    auto* shared = std::exchange(shared_, nullptr);
+    if (shared == nullptr) {
+      return;
+    }
+    if (shared->try_claim()) {
+      source_->run_callback_batches(batchSize_);
+      shared->finish_claim();
+    }
+    shared->release();
+  }
+
+ private:
+  friend in_place_stop_source;
+
+  in_place_stop_runner(in_place_stop_source* source, std::size_t batchSize,
+                       detail::in_place_stop_runners* shared) noexcept
+      : source_(source), batchSize_(batchSize), shared_(shared) {
+    shared_->add_ref();
+  }
+
+  in_place_stop_source* source_;
+  std::size_t batchSize_;
+  detail::in_place_stop_runners* shared_;
+};
+
+namespace detail {
+
+// Callbacks a thread took off a source's list and has not finished executing.
+// The batch is filled under the source's lock, then drained without it: each
+// pending callback sits in a slot that the runner exchanges for null to claim
+// it, and that remove_callback() compares and exchanges for null, under the
+// source's lock, to drop it. Slots are only refilled or freed under that lock,
+// so a remover that finds a callback's slot under it may always access it.
+// Batches of one thread form a stack through outer_, as a callback can
+// request stop on another source.
+class in_place_stop_batch {
+ public:
+  using slot = std::atomic<in_place_stop_callback_base*>;
+
+  explicit in_place_stop_batch(std::size_t capacity) noexcept
+      : outer_(current_) {
+    if (capacity > inline_capacity) {
+      // Without memory for a larger batch, take inline_capacity at a time.
+      heap_.reset(new (std::nothrow) slot[capacity]);  // NOLINT
+    }
+    slots_ = heap_ ? heap_.get() : inline_.data();
+    capacity_ = heap_ ? capacity : std::min(capacity, inline_capacity);
+    current_ = this;
+  }
+
+  in_place_stop_batch(const in_place_stop_batch&) = delete;
+  in_place_stop_batch(in_place_stop_batch&&) = delete;
+  auto operator=(const in_place_stop_batch&) -> in_place_stop_batch& = delete;
+  auto operator=(in_place_stop_batch&&) -> in_place_stop_batch& = delete;
+
+  ~in_place_stop_batch() { current_ = outer_; }
+
+  [[nodiscard]] auto empty() const noexcept -> bool { return size_ == 0; }
+
+  // Replaces the drained batch with up to capacity callbacks from the front
+  // of list. Requires the source's lock.
+  void take(in_place_stop_callback_base*& list) noexcept {
+    size_ = 0;
+    next_ = 0;
+    for (; size_ < capacity_ && list != nullptr; ++size_) {
+      auto* callback = list;
+      list = callback->next_;
+      callback->prevPtr_ = nullptr;
+      slots_[size_].store(callback, std::memory_order_relaxed);  // NOLINT
+      callback->slot_.store(&slots_[size_],                      // NOLINT
+                            std::memory_order_relaxed);
+    }
+    if (list != nullptr) {
+      list->prevPtr_ = &list;
+    }
+  }
+
+  // Claims the next callback that was not removed, or returns null once the
+  // batch is drained.
+  auto claim() noexcept -> in_place_stop_callback_base* {
+    while (next_ != size_) {
+      auto& entry = slots_[next_++];  // NOLINT
+      // Use the loaded pointer rather than the one exchanged out, which is
+      // the same unless it is null, so the callback can be loaded while the
+      // exchange is still in flight.
+      auto* callback = entry.load(std::memory_order_relaxed);
+      if (callback != nullptr &&
+          entry.exchange(nullptr, std::memory_order_acq_rel) != nullptr) {
+        callback->slot_.store(nullptr, std::memory_order_relaxed);
+        return callback;
+      }
+    }
+    return nullptr;
+  }
+
+  void execute(in_place_stop_callback_base* callback) noexcept {
+    running_ = callback;
+
+    bool removedDuringCallback = false;
+    callback->removedDuringCallback_ = &removedDuringCallback;
+
+    stop_metrics::add(stop_metric::callbacks_executed);
+    callback->execute();
+
+    if (!removedDuringCallback) {
+      callback->removedDuringCallback_ = nullptr;
+      callback->callbackCompleted_.store(true, std::memory_order_release);
+    }
+    running_ = nullptr;
+  }
+
+  // Drops a callback that is still pending in the batch of any thread.
+  // Returns false if a runner already claimed it. Requires the source's lock.
+  static auto try_drop(in_place_stop_callback_base* callback) noexcept
+      -> bool {
+    auto* entry = callback->slot_.load(std::memory_order_relaxed);
+    if (entry == nullptr) {
+      return false;
+    }
+    auto expected = callback;
+    if (!entry->compare_exchange_strong(expected, nullptr,
+                                        std::memory_order_acq_rel)) {
+      return false;
+    }
+    callback->slot_.store(nullptr, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Handles removal of a callback that this thread is executing from one of
+  // its batches. Returns false if it is not.
+  static auto try_remove(in_place_stop_callback_base* callback) noexcept
+      -> bool {
+    for (auto* batch = current_; batch != nullptr; batch = batch->outer_) {
+      if (batch->running_ == callback) {
+        *callback->removedDuringCallback_ = true;
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  static constexpr std::size_t inline_capacity = 64;
+
+  static inline thread_local in_place_stop_batch* current_ = nullptr;
+
+  in_place_stop_batch* outer_;
+  std::array<slot, inline_capacity> inline_{};
+  std::unique_ptr<slot[]> heap_;  // NOLINT
+  slot* slots_;
+  std::size_t capacity_;
+  std::size_t size_ = 0;
+  std::size_t next_ = 0;
+  in_place_stop_callback_base* running_ = nullptr;
+};
+
+}  // namespace detail
+
 class in_place_stop_token {
  public:
   template <typename F>
@@ -195,6 +495,7 @@ inline void in_place_stop_callback_base::register_callback() noexcept {
       source_ = nullptr;
       // Callback not registered because stop_requested() was true.
       // Execute inline here.
+      stop_metrics::add(stop_metric::callbacks_executed);
       execute();
     }
   }
@@ -207,6 +508,9 @@ inline in_place_stop_source::~in_place_stop_source() {
 }
 
 inline auto in_place_stop_source::request_stop() noexcept -> bool {
+  stop_metrics::add(stop_metric::stop_requests);
+  stop_metrics_timer timer{stop_metric::request_stop_ns};
+
   if (!try_lock_unless_stop_requested(true)) {
     return true;
   }
@@ -228,6 +532,7 @@ inline auto in_place_stop_source::request_stop() noexcept -> bool {
     bool removedDuringCallback = false;
     callback->removedDuringCallback_ = &removedDuringCallback;
 
+    stop_metrics::add(stop_metric::callbacks_executed);
     callback->execute();
 
     if (!removedDuringCallback) {
@@ -244,30 +549,106 @@ inline auto in_place_stop_source::request_stop() noexcept -> bool {
   return false;
 }
 
+inline auto in_place_stop_source::request_stop(
+    in_place_stop_batching options) noexcept -> bool {
+  options.parallelism = 1;
+  return request_stop(options, [](in_place_stop_runner runner) { runner(); });
+}
+
+template <typename Spawn>
+requires std::invocable<Spawn&, in_place_stop_runner>
+auto in_place_stop_source::request_stop(in_place_stop_batching options,
+                                        Spawn&& spawn) noexcept -> bool {
+  stop_metrics::add(stop_metric::stop_requests);
+  stop_metrics_timer timer{stop_metric::request_stop_ns};
+
+  if (!try_lock_unless_stop_requested(true)) {
+    return true;
+  }
+
+  // notifyingThreadId_ stays unset: callbacks may run on any runner thread,
+  // each of which tracks its own batches.
+  auto const empty = callbacks_ == nullptr;
+
+  // unlock()
+  state_.store(stop_requested_flag, std::memory_order_release);
+
+  if (empty) {
+    return false;
+  }
+
+  auto const batchSize = std::max<std::size_t>(options.batch_size, 1);
+  // Without memory for the shared state, run every batch on this thread.
+  auto* shared = options.parallelism > 1
+                     ? new (std::nothrow) detail::in_place_stop_runners{}
+                     : nullptr;
+  if (shared != nullptr) {
+    for (std::size_t i = 1; i < options.parallelism; ++i) {
+      try {
+        spawn(in_place_stop_runner{this, batchSize, shared});
+      } catch (...) {
+        // The runner released its reference when it was destroyed.
+        break;
+      }
+    }
+  }
+
+  run_callback_batches(batchSize);
+
+  if (shared != nullptr) {
+    shared->close_and_wait();
+    shared->release();
+  }
+
+  return false;
+}
+
+inline void in_place_stop_source::run_callback_batches(
+    std::size_t batchSize) noexcept {
+  detail::in_place_stop_batch batch{batchSize};
+  // Stop is requested, so the list can only shrink from here on.
+  while (true) {
+    auto const oldState = lock();
+    batch.take(callbacks_);
+    unlock(oldState);
+    if (batch.empty()) {
+      break;
+    }
+    while (auto* callback = batch.claim()) {
+      batch.execute(callback);
+    }
+  }
+}
+
 inline auto in_place_stop_source::lock() noexcept -> std::uint8_t {
   spin_wait spin;
   auto oldState = state_.load(std::memory_order_relaxed);
-  do {
+  while (true) {
     while ((oldState & locked_flag) != 0) {  // NOLINT
       spin.wait();
       oldState = state_.load(std::memory_order_relaxed);
     }
-  } while (!state_.compare_exchange_weak(  // NOLINT
-      oldState, oldState | locked_flag, std::memory_order_acquire,
-      std::memory_order_relaxed));
+    if (state_.compare_exchange_weak(oldState, oldState | locked_flag,
+                                     std::memory_order_acquire,
+                                     std::memory_order_relaxed)) {
+      break;
+    }
+    stop_metrics::add(stop_metric::cas_failures);
+  }
 
+  stop_metrics::add(stop_metric::lock_acquisitions);
   return oldState;
 }
 
 inline void in_place_stop_source::unlock(std::uint8_t oldState) noexcept {
-  (void)state_.store(oldState, std::memory_order_release);
+  state_.store(oldState, std::memory_order_release);
 }
 
 inline auto in_place_stop_source::try_lock_unless_stop_requested(
     bool setStopRequested) noexcept -> bool {
   spin_wait spin;
   auto oldState = state_.load(std::memory_order_relaxed);
-  do {
+  while (true) {
     while (true) {
       if ((oldState & stop_requested_flag) != 0) {
         // Stop already requested.
@@ -279,12 +660,18 @@ inline auto in_place_stop_source::try_lock_unless_stop_requested(
       spin.wait();
       oldState = state_.load(std::memory_order_relaxed);
     }
-  } while (!state_.compare_exchange_weak(  // NOLINT
-      oldState,
-      setStopRequested ? (locked_flag | stop_requested_flag) : locked_flag,
-      std::memory_order_acq_rel, std::memory_order_relaxed));
+    if (state_.compare_exchange_weak(
+            oldState,
+            setStopRequested ? (locked_flag | stop_requested_flag)
+                             : locked_flag,
+            std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      break;
+    }
+    stop_metrics::add(stop_metric::cas_failures);
+  }
 
   // Lock acquired successfully
+  stop_metrics::add(stop_metric::lock_acquisitions);
   return true;
 }
 
@@ -303,6 +690,8 @@ inline auto in_place_stop_source::try_add_callback(
 
   unlock(0);
 
+  stop_metrics::add(stop_metric::callbacks_registered);
+
   return true;
 }
 
@@ -311,26 +700,32 @@ inline void in_place_stop_source::remove_callback(
   auto oldState = lock();
 
   if (callback->prevPtr_ != nullptr) {
-    // Callback has not been executed yet.
-    // Remove from the list.
+    // Callback has not been executed yet, remove it from the list.
     *callback->prevPtr_ = callback->next_;
     if (callback->next_ != nullptr) {
       callback->next_->prevPtr_ = callback->prevPtr_;
     }
     unlock(oldState);
+  } else if (detail::in_place_stop_batch::try_drop(callback)) {
+    // Callback was pending in the batch of a runner, which now skips it.
+    unlock(oldState);
   } else {
     auto notifyingThreadId = notifyingThreadId_;
     unlock(oldState);
 
-    // Callback has either already been executed or is
-    // currently executing on another thread.
-    if (std::this_thread::get_id() == notifyingThreadId) {
+    // Callback has either already been executed, is executing from a batch
+    // of this thread, or is currently executing on another thread.
+    if (detail::in_place_stop_batch::try_remove(callback)) {
+      // This thread is executing the callback.
+    } else if (std::this_thread::get_id() == notifyingThreadId) {
       if (callback->removedDuringCallback_ != nullptr) {
         *callback->removedDuringCallback_ = true;
       }
     } else {
       // Concurrently executing on another thread.
       // Wait until the other thread finishes executing the callback.
+      stop_metrics::add(stop_metric::remove_callback_waits);
+      stop_metrics_timer timer{stop_metric::remove_callback_wait_ns};
       spin_wait spin;
       while (!callback->callbackCompleted_.load(std::memory_order_acquire)) {
         spin.wait();
@@ -0,0 +1,53 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <concepts>
+#include <tag_invoke.hpp>
+#include <type_traits>
+
+namespace execution {
+
+namespace _start {
+
+struct start_t {
+  template <class Operation>
+  requires functional::tag_invocable<start_t, Operation&>
+  void operator()(Operation& operation) const noexcept {
+    static_assert(functional::nothrow_tag_invocable<start_t, Operation&>);
+    tag_invoke(*this, operation);
+  }
+};
+
+}  // namespace _start
+
+inline constexpr _start::start_t start{};
+
+template <typename Operation>
+concept operation_state = std::destructible<Operation> &&
+    std::is_object_v<Operation> && requires(Operation& operation) {
+  start(operation);
+};
+
+}  // namespace execution
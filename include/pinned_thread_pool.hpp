@@ -0,0 +1,494 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cpu_topology.hpp>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <environment.hpp>
+#include <get_stop_token.hpp>
+#include <mutex>
+#include <operation_state.hpp>
+#include <ranges>
+#include <receiver.hpp>
+#include <schedule_bulk.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <stop_token_concepts.hpp>
+#include <tag_invoke.hpp>
+#include <task_queue.hpp>
+#include <thread>
+#include <tracing.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace execution {
+
+// Thread pool with one worker pinned to each given CPU and one queue per
+// worker ("core"). Work scheduled on a core runs there, unless it waits in
+// the queue while the core is busy: idle workers steal it, trying cores of
+// their own NUMA node before remote ones.
+//
+// schedule_bulk splices a batch into the target core's queue under one lock
+// and wakes idle workers, those of its node first, to steal from it. Batches
+// for any core scheduled from outside the pool are dealt out in one chunk per
+// core.
+class pinned_thread_pool {
+ public:
+  class scheduler;
+  class env;
+
+  pinned_thread_pool() : pinned_thread_pool(available_cpus()) {}
+
+  // One worker per entry of cpus. A CPU may be listed more than once.
+  explicit pinned_thread_pool(
+      std::vector<std::size_t> const& cpus,
+      cpu_topology const& topology = cpu_topology::detect());
+
+  pinned_thread_pool(const pinned_thread_pool&) = delete;
+  pinned_thread_pool(pinned_thread_pool&&) = delete;
+  auto operator=(const pinned_thread_pool&) -> pinned_thread_pool& = delete;
+  auto operator=(pinned_thread_pool&&) -> pinned_thread_pool& = delete;
+
+  // Runs all work still queued, then joins the workers.
+  ~pinned_thread_pool();
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return workers_.size();
+  }
+
+  [[nodiscard]] auto cpu_of(std::size_t core) const -> std::size_t {
+    return workers_.at(core).cpu;
+  }
+
+  [[nodiscard]] auto node_of(std::size_t core) const -> std::size_t {
+    return workers_.at(core).node;
+  }
+
+  // Cores whose queues the worker of core steals from, in the order it
+  // tries them: same NUMA node first, then remote ones.
+  [[nodiscard]] auto steal_order(std::size_t core) const
+      -> std::vector<std::size_t> const& {
+    return workers_.at(core).victims;
+  }
+
+  // False until the worker of core pinned itself, and forever if pinning
+  // failed, e.g. because the CPU is not available to the process.
+  [[nodiscard]] auto is_pinned(std::size_t core) const -> bool {
+    return workers_.at(core).pinned.load(std::memory_order_acquire);
+  }
+
+  // Runs work on the calling worker's core, or round robin over all cores
+  // when used from a thread outside the pool.
+  auto get_scheduler() noexcept -> scheduler;
+
+  auto get_scheduler_on(std::size_t core) noexcept -> scheduler;
+
+  // The scheduler of the calling worker's core, so that continuations stay
+  // where their data was produced. Same as get_scheduler() outside the pool.
+  auto current_scheduler() noexcept -> scheduler;
+
+  // Environment answering get_scheduler with current_scheduler().
+  auto get_env() noexcept -> env;
+
+ private:
+  friend scheduler;
+
+  static constexpr std::size_t any_core = static_cast<std::size_t>(-1);
+
+  struct worker {
+    std::size_t cpu = 0;
+    std::size_t node = 0;
+    std::vector<std::size_t> victims;  // Same node first, then remote.
+    std::mutex mutex;
+    task_queue queue;
+    std::atomic<std::uint32_t> epoch{0};
+    std::atomic<bool> sleeping{false};
+    std::atomic<bool> pinned{false};
+    std::thread thread;
+  };
+
+  void enqueue(std::size_t core, task_base* task) noexcept;
+  void enqueue(std::size_t core, task_queue tasks, std::size_t count) noexcept;
+  void push(std::size_t core, task_queue tasks, std::size_t count) noexcept;
+  void notify(worker& target, std::size_t count) noexcept;
+  auto try_pop(std::size_t core) noexcept -> task_base*;
+  auto try_steal(std::size_t core, bool blocking) noexcept -> task_base*;
+  void run(std::size_t core) noexcept;
+  void stop_and_join() noexcept;
+
+  static void wake(worker& w) noexcept {
+    w.epoch.fetch_add(1, std::memory_order_seq_cst);
+    w.epoch.notify_one();
+  }
+
+  static inline thread_local pinned_thread_pool* current_pool_ = nullptr;
+  static inline thread_local std::size_t current_core_ = 0;
+
+  std::vector<worker> workers_;
+  std::atomic<std::size_t> nextCore_{0};
+  std::atomic<bool> stopRequested_{false};
+};
+
+class pinned_thread_pool::scheduler {
+  template <class Receiver>
+  class operation : task_base {
+   public:
+    operation(pinned_thread_pool* pool, std::size_t core, Receiver&& receiver)
+        noexcept(std::is_nothrow_move_constructible_v<Receiver>)
+        : task_base(&operation::execute_impl),
+          pool_(pool),
+          core_(core),
+          receiver_(std::move(receiver)) {}
+
+    operation(const operation&) = delete;
+    operation(operation&&) = delete;
+    auto operator=(const operation&) -> operation& = delete;
+    auto operator=(operation&&) -> operation& = delete;
+
+    ~operation() = default;
+
+    friend void tag_invoke(functional::tag_t<start> /*unused*/,
+                           operation& op) noexcept {
+      trace(execution::get_env(op.receiver_), trace_event_kind::started,
+            "pinned_thread_pool::schedule", &op);
+      op.enqueue();
+    }
+
+   private:
+    friend scheduler;
+
+    void enqueue() noexcept { pool_->enqueue(core_, this); }
+
+    static void execute_impl(task_base* task) noexcept {
+      auto& op = *static_cast<operation*>(task);
+      auto const& env = execution::get_env(op.receiver_);
+      using token = stop_token_of_t<std::remove_cvref_t<decltype(env)>>;
+      // Work whose stop was requested while it was queued is not run.
+      if constexpr (!unstoppable_token<token> &&
+                    std::invocable<functional::tag_t<set_stopped>, Receiver>) {
+        if (execution::get_stop_token(env).stop_requested()) {
+          trace(env, trace_event_kind::cancelled,
+                "pinned_thread_pool::schedule", &op);
+          set_stopped(std::move(op.receiver_));
+          return;
+        }
+      }
+      trace(env, trace_event_kind::completed, "pinned_thread_pool::schedule",
+            &op);
+      set_value(std::move(op.receiver_));
+    }
+
+    pinned_thread_pool* pool_;
+    std::size_t core_;
+    Receiver receiver_;
+  };
+
+  template <class T>
+  struct is_operation : std::false_type {};
+
+  template <class Receiver>
+  struct is_operation<operation<Receiver>> : std::true_type {};
+
+  class sender {
+   public:
+    template <class Receiver>
+    requires receiver<Receiver> &&
+        std::invocable<functional::tag_t<set_value>,
+                       std::remove_cvref_t<Receiver>>
+    friend auto tag_invoke(functional::tag_t<connect> /*unused*/,
+                           sender const& s, Receiver&& r)
+        -> operation<std::remove_cvref_t<Receiver>> {
+      return {s.pool_, s.core_, std::forward<Receiver>(r)};
+    }
+
+    sender(pinned_thread_pool* pool, std::size_t core) noexcept
+        : pool_(pool), core_(core) {}
+
+   private:
+    pinned_thread_pool* pool_;
+    std::size_t core_;
+  };
+
+ public:
+  friend auto operator==(scheduler const& a, scheduler const& b) noexcept
+      -> bool = default;
+
+  friend auto tag_invoke(functional::tag_t<schedule> /*unused*/,
+                         scheduler const& s) noexcept -> sender {
+    return {s.pool_, s.core_};
+  }
+
+  template <std::ranges::input_range Operations>
+  requires is_operation<std::ranges::range_value_t<Operations>>::value
+  friend void tag_invoke(functional::tag_t<schedule_bulk> /*unused*/,
+                         scheduler const& s, Operations& ops) noexcept {
+    s.start_bulk(ops);
+  }
+
+ private:
+  friend pinned_thread_pool;
+
+  template <class Operations>
+  void start_bulk(Operations& ops) const noexcept {
+    task_queue tasks;
+    std::size_t count = 0;
+    for (auto& op : ops) {
+      if (op.pool_ != pool_ || op.core_ != core_) {
+        // Connected from another pool or core, so it goes to its own queue.
+        execution::start(op);
+        continue;
+      }
+      trace(execution::get_env(op.receiver_), trace_event_kind::started,
+            "pinned_thread_pool::schedule", &op);
+      tasks.push_back(&op);
+      ++count;
+    }
+    pool_->enqueue(core_, std::move(tasks), count);
+  }
+
+  scheduler(pinned_thread_pool* pool, std::size_t core) noexcept
+      : pool_(pool), core_(core) {}
+
+  pinned_thread_pool* pool_;
+  std::size_t core_;
+};
+
+class pinned_thread_pool::env {
+ public:
+  friend auto tag_invoke(functional::tag_t<execution::get_scheduler> /*unused*/,
+                         env const& e) noexcept -> scheduler {
+    return e.pool_->current_scheduler();
+  }
+
+ private:
+  friend pinned_thread_pool;
+
+  explicit env(pinned_thread_pool* pool) noexcept : pool_(pool) {}
+
+  pinned_thread_pool* pool_;
+};
+
+inline pinned_thread_pool::pinned_thread_pool(
+    std::vector<std::size_t> const& cpus, cpu_topology const& topology)
+    : workers_(std::max<std::size_t>(cpus.size(), 1)) {
+  for (std::size_t core = 0; core < workers_.size(); ++core) {
+    workers_[core].cpu = cpus.empty() ? 0 : cpus[core];
+    workers_[core].node = topology.node_of(workers_[core].cpu);
+  }
+  for (std::size_t core = 0; core < workers_.size(); ++core) {
+    auto& victims = workers_[core].victims;
+    for (bool local : {true, false}) {
+      for (std::size_t other = 0; other < workers_.size(); ++other) {
+        if (other != core &&
+            (workers_[other].node == workers_[core].node) == local) {
+          victims.push_back(other);
+        }
+      }
+    }
+  }
+
+  try {
+    for (std::size_t core = 0; core < workers_.size(); ++core) {
+      workers_[core].thread = std::thread{[this, core] { run(core); }};
+    }
+  } catch (...) {
+    stop_and_join();
+    throw;
+  }
+}
+
+inline pinned_thread_pool::~pinned_thread_pool() { stop_and_join(); }
+
+inline auto pinned_thread_pool::get_scheduler() noexcept -> scheduler {
+  return {this, any_core};
+}
+
+inline auto pinned_thread_pool::get_scheduler_on(std::size_t core) noexcept
+    -> scheduler {
+  return {this, core % workers_.size()};
+}
+
+inline auto pinned_thread_pool::current_scheduler() noexcept -> scheduler {
+  return current_pool_ == this ? scheduler{this, current_core_}
+                               : get_scheduler();
+}
+
+inline auto pinned_thread_pool::get_env() noexcept -> env { return env{this}; }
+
+inline void pinned_thread_pool::enqueue(std::size_t core,
+                                        task_base* task) noexcept {
+  if (core == any_core) {
+    core = current_pool_ == this
+               ? current_core_
+               : nextCore_.fetch_add(1, std::memory_order_relaxed) %
+                     workers_.size();
+  }
+  auto& target = workers_[core];
+  {
+    std::lock_guard lock{target.mutex};
+    target.queue.push_back(task);
+  }
+  notify(target, 1);
+}
+
+inline void pinned_thread_pool::enqueue(std::size_t core, task_queue tasks,
+                                        std::size_t count) noexcept {
+  if (count == 0) {
+    return;
+  }
+  if (core != any_core) {
+    push(core, std::move(tasks), count);
+    return;
+  }
+  if (current_pool_ == this) {
+    push(current_core_, std::move(tasks), count);
+    return;
+  }
+  auto const cores = std::min(count, workers_.size());
+  auto const first = nextCore_.fetch_add(cores, std::memory_order_relaxed);
+  for (std::size_t i = 0; i < cores; ++i) {
+    auto const chunkSize = count / cores + (i < count % cores ? 1 : 0);
+    task_queue chunk;
+    for (std::size_t j = 0; j < chunkSize; ++j) {
+      chunk.push_back(tasks.pop_front());
+    }
+    push((first + i) % workers_.size(), std::move(chunk), chunkSize);
+  }
+}
+
+inline void pinned_thread_pool::push(std::size_t core, task_queue tasks,
+                                     std::size_t count) noexcept {
+  auto& target = workers_[core];
+  {
+    std::lock_guard lock{target.mutex};
+    target.queue.append(std::move(tasks));
+  }
+  notify(target, count);
+}
+
+inline void pinned_thread_pool::notify(worker& target,
+                                       std::size_t count) noexcept {
+  // Pairs with the epoch load in run(): either the worker sees the new epoch
+  // and does not sleep, or we see it sleeping and wake it.
+  target.epoch.fetch_add(1, std::memory_order_seq_cst);
+  if (target.sleeping.load(std::memory_order_seq_cst)) {
+    target.epoch.notify_one();
+    if (--count == 0) {
+      return;
+    }
+  }
+
+  // The owner can start only one task; let idle workers steal the rest, one
+  // worker per task. The victims of target are ordered by node distance, so
+  // workers of its own node are woken before remote ones.
+  for (auto victim : target.victims) {
+    auto& sibling = workers_[victim];
+    if (sibling.sleeping.load(std::memory_order_seq_cst)) {
+      wake(sibling);
+      if (--count == 0) {
+        break;
+      }
+    }
+  }
+}
+
+inline auto pinned_thread_pool::try_pop(std::size_t core) noexcept
+    -> task_base* {
+  auto& w = workers_[core];
+  std::lock_guard lock{w.mutex};
+  return w.queue.pop_front();
+}
+
+// Skips victims whose lock is taken, unless blocking.
+inline auto pinned_thread_pool::try_steal(std::size_t core,
+                                          bool blocking) noexcept
+    -> task_base* {
+  for (auto victim : workers_[core].victims) {
+    auto& w = workers_[victim];
+    std::unique_lock lock{w.mutex, std::defer_lock};
+    if (blocking) {
+      lock.lock();
+    } else if (!lock.try_lock()) {
+      continue;
+    }
+    if (auto* task = w.queue.pop_front()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+inline void pinned_thread_pool::run(std::size_t core) noexcept {
+  auto& self = workers_[core];
+  self.pinned.store(pin_current_thread(self.cpu), std::memory_order_release);
+  current_pool_ = this;
+  current_core_ = core;
+
+  while (true) {
+    auto const epoch = self.epoch.load(std::memory_order_seq_cst);
+    auto* task = try_pop(core);
+    if (task == nullptr) {
+      task = try_steal(core, false);
+    }
+    if (task == nullptr) {
+      if (stopRequested_.load(std::memory_order_acquire)) {
+        return;
+      }
+      self.sleeping.store(true, std::memory_order_seq_cst);
+      // notify() only bumps the epoch of workers it sees sleeping. Scan once
+      // more, taking every lock: a task pushed under a lock taken before
+      // ours is found here, and one pushed after it sees us sleeping.
+      task = try_pop(core);
+      if (task == nullptr) {
+        task = try_steal(core, true);
+      }
+      if (task == nullptr) {
+        self.epoch.wait(epoch, std::memory_order_seq_cst);
+      }
+      self.sleeping.store(false, std::memory_order_relaxed);
+    }
+    if (task != nullptr) {
+      task->execute();
+    }
+  }
+}
+
+inline void pinned_thread_pool::stop_and_join() noexcept {
+  stopRequested_.store(true, std::memory_order_release);
+  for (auto& w : workers_) {
+    wake(w);
+  }
+  for (auto& w : workers_) {
+    if (w.thread.joinable()) {
+      w.thread.join();
+    }
+  }
+}
+
+}  // namespace execution
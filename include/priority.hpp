@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <environment.hpp>
+#include <tag_invoke.hpp>
+
+namespace execution {
+
+enum class priority : std::uint8_t { high, normal, low };
+
+inline constexpr std::size_t priority_levels = 3;
+
+namespace _get_priority {
+
+struct get_priority_t {
+  template <class Env>
+  requires functional::tag_invocable<get_priority_t, Env const&>
+  constexpr auto operator()(Env const& env) const noexcept(
+      functional::nothrow_tag_invocable<get_priority_t, Env const&>)
+      -> priority {
+    using result_t =
+        functional::tag_invoke_result_t<get_priority_t, Env const&>;
+    static_assert(std::same_as<result_t, priority>);
+    return tag_invoke(*this, env);
+  }
+
+  friend constexpr auto tag_invoke(
+      functional::tag_t<forwarding_env_query> /*unused*/,
+      get_priority_t /*unused*/) noexcept -> bool {
+    return true;
+  }
+};
+
+}  // namespace _get_priority
+
+inline constexpr _get_priority::get_priority_t get_priority{};
+
+// get_priority(env) if env answers it, otherwise fallback.
+template <class Env>
+constexpr auto priority_of(Env const& env, priority fallback) noexcept
+    -> priority {
+  if constexpr (functional::tag_invocable<functional::tag_t<get_priority>,
+                                          Env const&>) {
+    return get_priority(env);
+  } else {
+    return fallback;
+  }
+}
+
+}  // namespace execution
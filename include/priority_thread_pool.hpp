@@ -0,0 +1,411 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <environment.hpp>
+#include <get_stop_token.hpp>
+#include <operation_state.hpp>
+#include <priority.hpp>
+#include <ranges>
+#include <receiver.hpp>
+#include <schedule_bulk.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <stop_token_concepts.hpp>
+#include <tag_invoke.hpp>
+#include <task_queue.hpp>
+#include <thread>
+#include <tracing.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace execution {
+
+// Thread pool with one queue per priority level. Workers take the highest
+// priority work available, except that a non-empty level passed over
+// aging_threshold times gets the next turn, so low priority never starves.
+//
+// Scheduling into a level is lock-free. Taking from a level is not: workers
+// pop from it one at a time, but one that finds the level busy tries the
+// other levels and retries rather than waiting, so it may briefly run lower
+// priority work first.
+//
+// Scheduled operations take their priority from get_priority on their
+// receiver's environment, or else from the scheduler they came from.
+// schedule_bulk pushes each level's share of a batch with one atomic
+// operation and wakes at most one sleeping worker per task.
+class priority_thread_pool {
+ public:
+  class scheduler;
+
+  static constexpr std::uint32_t default_aging_threshold = 16;
+
+  explicit priority_thread_pool(
+      std::size_t threadCount = std::max(std::thread::hardware_concurrency(),
+                                         1U),
+      std::uint32_t agingThreshold = default_aging_threshold);
+
+  priority_thread_pool(const priority_thread_pool&) = delete;
+  priority_thread_pool(priority_thread_pool&&) = delete;
+  auto operator=(const priority_thread_pool&) -> priority_thread_pool& = delete;
+  auto operator=(priority_thread_pool&&) -> priority_thread_pool& = delete;
+
+  // Runs all work still queued, then joins the workers.
+  ~priority_thread_pool();
+
+  [[nodiscard]] auto size() const noexcept -> std::size_t {
+    return threads_.size();
+  }
+
+  // Work whose receiver environment has no priority runs at fallback.
+  auto get_scheduler(priority fallback = priority::normal) noexcept
+      -> scheduler;
+
+ private:
+  // Producers push without locking. Consumers serialize on a flag that is
+  // held to refill the ready queue from the inbox, which is linear in the
+  // number of tasks pushed since the last refill, and to pop one task. The
+  // flag is only ever tried: a worker finding it taken moves on to the other
+  // levels and comes back later, so a preempted holder delays just this
+  // level's next task instead of blocking every worker behind it.
+  class level_queue {
+   public:
+    void push(task_base* task) noexcept {
+      size_.fetch_add(1, std::memory_order_relaxed);
+      inbox_.push(task);
+    }
+
+    void push_all(task_queue tasks, std::size_t count) noexcept {
+      size_.fetch_add(count, std::memory_order_relaxed);
+      inbox_.push_all(std::move(tasks));
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t {
+      return size_.load(std::memory_order_relaxed);
+    }
+
+    // Returns null if the level is empty or another worker is popping.
+    auto try_pop() noexcept -> task_base* {
+      if (size() == 0 || consuming_.test_and_set(std::memory_order_acquire)) {
+        return nullptr;
+      }
+      if (ready_.empty()) {
+        ready_ = inbox_.take_all();
+      }
+      auto* task = ready_.pop_front();
+      consuming_.clear(std::memory_order_release);
+      if (task != nullptr) {
+        size_.fetch_sub(1, std::memory_order_relaxed);
+      }
+      return task;
+    }
+
+   private:
+    atomic_task_inbox inbox_;
+    std::atomic<std::size_t> size_{0};
+    std::atomic_flag consuming_;
+    task_queue ready_;
+  };
+
+  // Tasks of a schedule_bulk call, split by level.
+  struct batch {
+    std::array<task_queue, priority_levels> levels;
+    std::array<std::size_t, priority_levels> counts{};
+
+    void push(priority p, task_base* task) noexcept {
+      auto const level = static_cast<std::size_t>(p);
+      levels[level].push_back(task);  // NOLINT
+      ++counts[level];                // NOLINT
+    }
+  };
+
+  void enqueue(priority p, task_base* task) noexcept;
+  void enqueue(batch& tasks) noexcept;
+  void wake(std::size_t count) noexcept;
+  auto pick() noexcept -> task_base*;
+  [[nodiscard]] auto has_work() const noexcept -> bool;
+  void run() noexcept;
+  void stop_and_join() noexcept;
+
+  std::array<level_queue, priority_levels> levels_;
+  std::array<std::atomic<std::uint32_t>, priority_levels> skipped_{};
+  std::uint32_t agingThreshold_;
+  std::atomic<std::uint32_t> epoch_{0};
+  std::atomic<std::uint32_t> sleepers_{0};
+  std::atomic<bool> stopRequested_{false};
+  std::vector<std::thread> threads_;
+};
+
+class priority_thread_pool::scheduler {
+  template <class Receiver>
+  class operation : task_base {
+   public:
+    operation(priority_thread_pool* pool, priority fallback,
+              Receiver&& receiver)
+        noexcept(std::is_nothrow_move_constructible_v<Receiver>)
+        : task_base(&operation::execute_impl),
+          pool_(pool),
+          fallback_(fallback),
+          receiver_(std::move(receiver)) {}
+
+    operation(const operation&) = delete;
+    operation(operation&&) = delete;
+    auto operator=(const operation&) -> operation& = delete;
+    auto operator=(operation&&) -> operation& = delete;
+
+    ~operation() = default;
+
+    friend void tag_invoke(functional::tag_t<start> /*unused*/,
+                           operation& op) noexcept {
+      auto const& env = execution::get_env(op.receiver_);
+      trace(env, trace_event_kind::started, "priority_thread_pool::schedule",
+            &op);
+      op.enqueue(priority_of(env, op.fallback_));
+    }
+
+   private:
+    friend scheduler;
+
+    void enqueue(priority p) noexcept { pool_->enqueue(p, this); }
+
+    static void execute_impl(task_base* task) noexcept {
+      auto& op = *static_cast<operation*>(task);
+      auto const& env = execution::get_env(op.receiver_);
+      using token = stop_token_of_t<std::remove_cvref_t<decltype(env)>>;
+      // Work whose stop was requested while it was queued is not run.
+      if constexpr (!unstoppable_token<token> &&
+                    std::invocable<functional::tag_t<set_stopped>, Receiver>) {
+        if (execution::get_stop_token(env).stop_requested()) {
+          trace(env, trace_event_kind::cancelled,
+                "priority_thread_pool::schedule", &op);
+          set_stopped(std::move(op.receiver_));
+          return;
+        }
+      }
+      trace(env, trace_event_kind::completed, "priority_thread_pool::schedule",
+            &op);
+      set_value(std::move(op.receiver_));
+    }
+
+    priority_thread_pool* pool_;
+    priority fallback_;
+    Receiver receiver_;
+  };
+
+  template <class T>
+  struct is_operation : std::false_type {};
+
+  template <class Receiver>
+  struct is_operation<operation<Receiver>> : std::true_type {};
+
+  class sender {
+   public:
+    template <class Receiver>
+    requires receiver<Receiver> &&
+        std::invocable<functional::tag_t<set_value>,
+                       std::remove_cvref_t<Receiver>>
+    friend auto tag_invoke(functional::tag_t<connect> /*unused*/,
+                           sender const& s, Receiver&& r)
+        -> operation<std::remove_cvref_t<Receiver>> {
+      return {s.pool_, s.fallback_, std::forward<Receiver>(r)};
+    }
+
+    sender(priority_thread_pool* pool, priority fallback) noexcept
+        : pool_(pool), fallback_(fallback) {}
+
+   private:
+    priority_thread_pool* pool_;
+    priority fallback_;
+  };
+
+ public:
+  friend auto operator==(scheduler const& a, scheduler const& b) noexcept
+      -> bool = default;
+
+  friend auto tag_invoke(functional::tag_t<schedule> /*unused*/,
+                         scheduler const& s) noexcept -> sender {
+    return {s.pool_, s.fallback_};
+  }
+
+  template <std::ranges::input_range Operations>
+  requires is_operation<std::ranges::range_value_t<Operations>>::value
+  friend void tag_invoke(functional::tag_t<schedule_bulk> /*unused*/,
+                         scheduler const& s, Operations& ops) noexcept {
+    s.start_bulk(ops);
+  }
+
+ private:
+  friend priority_thread_pool;
+
+  template <class Operations>
+  void start_bulk(Operations& ops) const noexcept {
+    priority_thread_pool::batch tasks;
+    for (auto& op : ops) {
+      if (op.pool_ != pool_) {
+        // Connected from another pool, so it has to be scheduled there.
+        execution::start(op);
+        continue;
+      }
+      auto const& env = execution::get_env(op.receiver_);
+      trace(env, trace_event_kind::started, "priority_thread_pool::schedule",
+            &op);
+      tasks.push(priority_of(env, op.fallback_), &op);
+    }
+    pool_->enqueue(tasks);
+  }
+
+  scheduler(priority_thread_pool* pool, priority fallback) noexcept
+      : pool_(pool), fallback_(fallback) {}
+
+  priority_thread_pool* pool_;
+  priority fallback_;
+};
+
+inline priority_thread_pool::priority_thread_pool(std::size_t threadCount,
+                                                  std::uint32_t agingThreshold)
+    : agingThreshold_(agingThreshold) {
+  threadCount = std::max<std::size_t>(threadCount, 1);
+  threads_.reserve(threadCount);
+  try {
+    for (std::size_t i = 0; i < threadCount; ++i) {
+      threads_.emplace_back([this] { run(); });
+    }
+  } catch (...) {
+    stop_and_join();
+    throw;
+  }
+}
+
+inline priority_thread_pool::~priority_thread_pool() { stop_and_join(); }
+
+inline auto priority_thread_pool::get_scheduler(priority fallback) noexcept
+    -> scheduler {
+  return {this, fallback};
+}
+
+inline void priority_thread_pool::enqueue(priority p,
+                                          task_base* task) noexcept {
+  levels_[static_cast<std::size_t>(p)].push(task);  // NOLINT
+  wake(1);
+}
+
+inline void priority_thread_pool::enqueue(batch& tasks) noexcept {
+  std::size_t count = 0;
+  for (std::size_t level = 0; level < priority_levels; ++level) {
+    if (tasks.counts[level] != 0) {
+      levels_[level].push_all(std::move(tasks.levels[level]),
+                              tasks.counts[level]);
+      count += tasks.counts[level];
+    }
+  }
+  if (count != 0) {
+    wake(count);
+  }
+}
+
+inline void priority_thread_pool::wake(std::size_t count) noexcept {
+  // Pairs with the epoch load in run(): either a worker about to sleep sees
+  // the new epoch, or we see it counted as sleeper and wake it.
+  epoch_.fetch_add(1, std::memory_order_seq_cst);
+  auto const sleepers = sleepers_.load(std::memory_order_seq_cst);
+  if (count >= sleepers) {
+    if (sleepers != 0) {
+      epoch_.notify_all();
+    }
+    return;
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    epoch_.notify_one();
+  }
+}
+
+inline auto priority_thread_pool::pick() noexcept -> task_base* {
+  // A level that was passed over often enough goes first, lowest first.
+  for (auto level = priority_levels - 1; level > 0; --level) {
+    if (skipped_[level].load(std::memory_order_relaxed) >= agingThreshold_) {
+      if (auto* task = levels_[level].try_pop()) {
+        skipped_[level].store(0, std::memory_order_relaxed);
+        return task;
+      }
+    }
+  }
+  for (std::size_t level = 0; level < priority_levels; ++level) {
+    if (auto* task = levels_[level].try_pop()) {
+      skipped_[level].store(0, std::memory_order_relaxed);
+      for (auto lower = level + 1; lower < priority_levels; ++lower) {
+        if (levels_[lower].size() != 0) {
+          skipped_[lower].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+inline auto priority_thread_pool::has_work() const noexcept -> bool {
+  return std::ranges::any_of(
+      levels_, [](level_queue const& level) { return level.size() != 0; });
+}
+
+inline void priority_thread_pool::run() noexcept {
+  while (true) {
+    auto const epoch = epoch_.load(std::memory_order_seq_cst);
+    if (auto* task = pick()) {
+      task->execute();
+      continue;
+    }
+    if (has_work()) {
+      // Another worker is popping from the levels with work left.
+      std::this_thread::yield();
+      continue;
+    }
+    if (stopRequested_.load(std::memory_order_acquire)) {
+      return;
+    }
+    sleepers_.fetch_add(1, std::memory_order_seq_cst);
+    epoch_.wait(epoch, std::memory_order_seq_cst);
+    sleepers_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+inline void priority_thread_pool::stop_and_join() noexcept {
+  stopRequested_.store(true, std::memory_order_release);
+  epoch_.fetch_add(1, std::memory_order_seq_cst);
+  epoch_.notify_all();
+  for (auto& thread : threads_) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+}  // namespace execution
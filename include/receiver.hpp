@@ -0,0 +1,88 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <concepts>
+#include <environment.hpp>
+#include <tag_invoke.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace execution {
+
+namespace _set_value {
+
+struct set_value_t {
+  template <class Receiver, class... Values>
+  requires functional::tag_invocable<set_value_t, Receiver, Values...>
+  void operator()(Receiver&& receiver, Values&&... values) const noexcept {
+    static_assert(
+        functional::nothrow_tag_invocable<set_value_t, Receiver, Values...>);
+    tag_invoke(*this, std::forward<Receiver>(receiver),
+               std::forward<Values>(values)...);
+  }
+};
+
+}  // namespace _set_value
+
+inline constexpr _set_value::set_value_t set_value{};
+
+namespace _set_error {
+
+struct set_error_t {
+  template <class Receiver, class Error>
+  requires functional::tag_invocable<set_error_t, Receiver, Error>
+  void operator()(Receiver&& receiver, Error&& error) const noexcept {
+    static_assert(
+        functional::nothrow_tag_invocable<set_error_t, Receiver, Error>);
+    tag_invoke(*this, std::forward<Receiver>(receiver),
+               std::forward<Error>(error));
+  }
+};
+
+}  // namespace _set_error
+
+inline constexpr _set_error::set_error_t set_error{};
+
+namespace _set_stopped {
+
+struct set_stopped_t {
+  template <class Receiver>
+  requires functional::tag_invocable<set_stopped_t, Receiver>
+  void operator()(Receiver&& receiver) const noexcept {
+    static_assert(functional::nothrow_tag_invocable<set_stopped_t, Receiver>);
+    tag_invoke(*this, std::forward<Receiver>(receiver));
+  }
+};
+
+}  // namespace _set_stopped
+
+inline constexpr _set_stopped::set_stopped_t set_stopped{};
+
+template <typename Receiver>
+concept receiver = environment_provier<std::remove_cvref_t<Receiver>> &&
+    std::move_constructible<std::remove_cvref_t<Receiver>> &&
+    std::constructible_from<std::remove_cvref_t<Receiver>, Receiver>;
+
+}  // namespace execution
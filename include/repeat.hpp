@@ -0,0 +1,371 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <atomic>
+#include <concepts>
+#include <emplace_from.hpp>
+#include <environment.hpp>
+#include <exception>
+#include <functional>
+#include <get_stop_token.hpp>
+#include <operation_state.hpp>
+#include <optional>
+#include <receiver.hpp>
+#include <sender.hpp>
+#include <stop_token_concepts.hpp>
+#include <tag_invoke.hpp>
+#include <thread>
+#include <tracing.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace execution {
+
+namespace _repeat {
+
+// Passed as the predicate by retry(), which repeats on errors rather than
+// on values.
+struct until_value {};
+
+// The receiver is nested in a class template so that operation, which
+// needs the receiver's type to name its child operation, is not one of its
+// associated classes and is not instantiated by ADL for its queries.
+template <class Operation, class Receiver>
+struct receiver_t {
+  class type {
+   public:
+    explicit type(Operation* op) noexcept : op_(op) {}
+
+    template <class Self, class... Values>
+    requires std::same_as<Self, type>
+    friend void tag_invoke(functional::tag_t<set_value> /*unused*/, Self&& self,
+                           Values&&... values) noexcept {
+      self.op_->on_value(std::forward<Values>(values)...);
+    }
+
+    template <class Self, class Error>
+    requires std::same_as<Self, type>
+    friend void tag_invoke(functional::tag_t<set_error> /*unused*/, Self&& self,
+                           Error&& error) noexcept {
+      self.op_->on_error(std::forward<Error>(error));
+    }
+
+    template <class Self>
+    requires std::same_as<Self, type> &&
+        std::invocable<functional::tag_t<set_stopped>, Receiver>
+    friend void tag_invoke(functional::tag_t<set_stopped> /*unused*/,
+                           Self&& self) noexcept {
+      self.op_->on_stopped();
+    }
+
+    friend auto tag_invoke(functional::tag_t<get_env> /*unused*/,
+                           type const& self)
+        -> decltype(forward_env(
+            execution::get_env(std::declval<Receiver const&>()))) {
+      return forward_env(execution::get_env(self.op_->outer_receiver()));
+    }
+
+   private:
+    Operation* op_;
+  };
+};
+
+// Connects and starts the child once per iteration, destroying the previous
+// child operation in place. Iterations that complete inline are driven by a
+// loop in run() rather than by recursion, and iterations that complete on
+// another thread continue the loop there.
+//
+// The final completion may destroy the operation, so it is delivered only
+// once run() no longer touches it: inline completions mark run()'s frame as
+// finished, and completions on another thread first wait for run() to hand
+// the operation over.
+template <class Sender, class Receiver, class Predicate>
+class operation {
+  using child_receiver = typename receiver_t<operation, Receiver>::type;
+  using child_operation = connect_result_t<Sender&, child_receiver>;
+  using stop_token_type =
+      stop_token_of_t<decltype(execution::get_env(std::declval<Receiver&>()))>;
+
+  static constexpr bool repeat_on_error = std::same_as<Predicate, until_value>;
+  static constexpr const char* trace_name =
+      repeat_on_error ? "retry" : "repeat_effect_until";
+
+  enum class phase : unsigned char {
+    starting,          // run() is in or just past start(child).
+    completed_inline,  // The child asked for another iteration.
+    detached,          // run() returned; the completion drives.
+    handing_over,      // A final completion waits for run() to let go.
+    released,          // run() let go and will not touch *this again.
+  };
+
+ public:
+  operation(Sender sender, Receiver receiver, Predicate predicate) noexcept(
+      std::is_nothrow_move_constructible_v<Sender>&&
+          std::is_nothrow_move_constructible_v<Receiver>&&
+              std::is_nothrow_move_constructible_v<Predicate>)
+      : sender_(std::move(sender)),
+        receiver_(std::move(receiver)),
+        predicate_(std::move(predicate)) {}
+
+  operation(const operation&) = delete;
+  operation(operation&&) = delete;
+  auto operator=(const operation&) -> operation& = delete;
+  auto operator=(operation&&) -> operation& = delete;
+
+  ~operation() = default;
+
+  friend void tag_invoke(functional::tag_t<start> /*unused*/,
+                         operation& op) noexcept {
+    trace(execution::get_env(op.receiver_), trace_event_kind::started,
+          trace_name, &op);
+    op.run();
+  }
+
+  // Completion hooks for the child receiver.
+  template <class... Values>
+  void on_value(Values&&... values) noexcept {
+    if constexpr (repeat_on_error) {
+      finish(trace_event_kind::completed, [&]() noexcept {
+        set_value(std::move(receiver_), std::forward<Values>(values)...);
+      });
+    } else {
+      if constexpr (std::is_nothrow_invocable_v<Predicate&>) {
+        if (!std::invoke(predicate_)) {
+          repeat();
+          return;
+        }
+      } else {
+        try {
+          if (!std::invoke(predicate_)) {
+            repeat();
+            return;
+          }
+        } catch (...) {
+          finish(trace_event_kind::completed,
+                 [this, error = std::current_exception()]() mutable noexcept {
+                   child_.reset();
+                   set_error(std::move(receiver_), std::move(error));
+                 });
+          return;
+        }
+      }
+      finish(trace_event_kind::completed, [this]() noexcept {
+        child_.reset();
+        set_value(std::move(receiver_));
+      });
+    }
+  }
+
+  template <class Error>
+  void on_error(Error&& error) noexcept {
+    if constexpr (repeat_on_error) {
+      repeat();
+    } else {
+      finish(trace_event_kind::completed, [&]() noexcept {
+        set_error(std::move(receiver_), std::forward<Error>(error));
+      });
+    }
+  }
+
+  void on_stopped() noexcept {
+    finish(trace_event_kind::cancelled,
+           [this]() noexcept { set_stopped(std::move(receiver_)); });
+  }
+
+  [[nodiscard]] auto outer_receiver() const noexcept -> Receiver const& {
+    return receiver_;
+  }
+
+ private:
+  void run() noexcept {
+    bool finished = false;
+    finished_ = &finished;
+    while (true) {
+      if constexpr (!unstoppable_token<stop_token_type>) {
+        auto const& env = execution::get_env(receiver_);
+        if (execution::get_stop_token(env).stop_requested()) {
+          trace(env, trace_event_kind::cancelled, trace_name, this);
+          child_.reset();
+          set_stopped(std::move(receiver_));
+          return;
+        }
+      }
+      if constexpr (std::is_nothrow_invocable_v<functional::tag_t<connect>,
+                                                Sender&, child_receiver>) {
+        emplace_child();
+      } else {
+        try {
+          emplace_child();
+        } catch (...) {
+          trace(execution::get_env(receiver_), trace_event_kind::completed,
+                trace_name, this);
+          child_.reset();
+          set_error(std::move(receiver_), std::current_exception());
+          return;
+        }
+      }
+      driver_ = std::this_thread::get_id();
+      phase_.store(phase::starting, std::memory_order_relaxed);
+      execution::start(*child_);
+      if (finished) {
+        return;  // *this may be gone.
+      }
+      // Only the completion publishes completed_inline, so seeing it needs
+      // no read-modify-write, which keeps synchronous iterations cheap.
+      auto current = phase_.load(std::memory_order_acquire);
+      if (current == phase::starting &&
+          phase_.compare_exchange_strong(current, phase::detached,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_acquire)) {
+        return;
+      }
+      if (current == phase::handing_over) {
+        phase_.store(phase::released, std::memory_order_release);
+        return;
+      }
+    }
+  }
+
+  void emplace_child() {
+    child_.emplace(emplace_from{
+        [this] { return connect(sender_, child_receiver{this}); }});
+  }
+
+  // Delivers the final completion once run() is done with *this.
+  template <class Complete>
+  void finish(trace_event_kind kind, Complete&& complete) noexcept {
+    trace(execution::get_env(receiver_), kind, trace_name, this);
+    if (phase_.load(std::memory_order_relaxed) == phase::starting &&
+        driver_ == std::this_thread::get_id()) {
+      // Completing inside start(child), run() is further up this stack.
+      *finished_ = true;
+      complete();
+      return;
+    }
+    auto expected = phase::starting;
+    if (phase_.compare_exchange_strong(expected, phase::handing_over,
+                                       std::memory_order_acq_rel)) {
+      // run() is between start(child) returning and looking at phase_.
+      while (phase_.load(std::memory_order_acquire) != phase::released) {
+        std::this_thread::yield();
+      }
+    }
+    complete();
+  }
+
+  // Called when the child has completed and another iteration is due.
+  void repeat() noexcept {
+    auto expected = phase::starting;
+    if (!phase_.compare_exchange_strong(expected, phase::completed_inline,
+                                        std::memory_order_acq_rel)) {
+      run();
+    }
+  }
+
+  Sender sender_;
+  Receiver receiver_;
+  [[no_unique_address]] Predicate predicate_;
+  std::optional<child_operation> child_;
+  std::atomic<phase> phase_{phase::starting};
+  std::thread::id driver_;
+  bool* finished_ = nullptr;
+};
+
+template <class Sender, class Predicate>
+class sender_t {
+ public:
+  sender_t(Sender sender, Predicate predicate) noexcept(
+      std::is_nothrow_move_constructible_v<Sender>&&
+          std::is_nothrow_move_constructible_v<Predicate>)
+      : sender_(std::move(sender)), predicate_(std::move(predicate)) {}
+
+  template <class Self, class Receiver>
+  requires std::same_as<std::remove_cvref_t<Self>, sender_t> &&
+      receiver<Receiver> &&
+      sender_to<Sender&, typename receiver_t<
+                             operation<Sender, std::remove_cvref_t<Receiver>,
+                                       Predicate>,
+                             std::remove_cvref_t<Receiver>>::type>
+  friend auto tag_invoke(functional::tag_t<connect> /*unused*/, Self&& self,
+                         Receiver&& r)
+      -> operation<Sender, std::remove_cvref_t<Receiver>, Predicate> {
+    return {std::forward<Self>(self).sender_, std::forward<Receiver>(r),
+            std::forward<Self>(self).predicate_};
+  }
+
+ private:
+  Sender sender_;
+  [[no_unique_address]] Predicate predicate_;
+};
+
+struct repeat_effect_until_t {
+  template <class Sender, class Predicate>
+  requires functional::tag_invocable<repeat_effect_until_t, Sender, Predicate>
+  auto operator()(Sender&& sender, Predicate&& predicate) const
+      noexcept(functional::nothrow_tag_invocable<repeat_effect_until_t,
+                                                 Sender, Predicate>)
+          -> functional::tag_invoke_result_t<repeat_effect_until_t, Sender,
+                                             Predicate> {
+    return tag_invoke(*this, std::forward<Sender>(sender),
+                      std::forward<Predicate>(predicate));
+  }
+
+  template <class Sender, class Predicate>
+  requires std::predicate<std::remove_cvref_t<Predicate>&>
+  auto operator()(Sender&& sender, Predicate&& predicate) const
+      -> sender_t<std::remove_cvref_t<Sender>,
+                  std::remove_cvref_t<Predicate>> {
+    return {std::forward<Sender>(sender), std::forward<Predicate>(predicate)};
+  }
+};
+
+struct retry_t {
+  template <class Sender>
+  requires functional::tag_invocable<retry_t, Sender>
+  auto operator()(Sender&& sender) const
+      noexcept(functional::nothrow_tag_invocable<retry_t, Sender>)
+          -> functional::tag_invoke_result_t<retry_t, Sender> {
+    return tag_invoke(*this, std::forward<Sender>(sender));
+  }
+
+  template <class Sender>
+  auto operator()(Sender&& sender) const
+      -> sender_t<std::remove_cvref_t<Sender>, until_value> {
+    return {std::forward<Sender>(sender), until_value{}};
+  }
+};
+
+}  // namespace _repeat
+
+// Runs the effect sender again each time it completes with a value, until
+// predicate() returns true. Stops early when the receiver's stop token is
+// triggered between iterations.
+inline constexpr _repeat::repeat_effect_until_t repeat_effect_until{};
+
+// Runs the sender again each time it completes with an error, forwarding its
+// first value or stopped completion.
+inline constexpr _repeat::retry_t retry{};
+
+}  // namespace execution
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <concepts>
+#include <operation_state.hpp>
+#include <ranges>
+#include <scheduler.hpp>
+#include <tag_invoke.hpp>
+#include <type_traits>
+
+namespace execution {
+
+namespace _schedule_bulk {
+
+template <class Operations>
+concept operation_range = std::ranges::input_range<Operations> &&
+    std::is_lvalue_reference_v<std::ranges::range_reference_t<Operations>> &&
+    operation_state<std::ranges::range_value_t<Operations>>;
+
+struct schedule_bulk_t {
+  template <class Scheduler, operation_range Operations>
+  requires scheduler<Scheduler const&> &&
+      functional::tag_invocable<schedule_bulk_t, Scheduler const&,
+                                Operations&>
+  void operator()(Scheduler const& sched, Operations&& ops) const noexcept {
+    static_assert(functional::nothrow_tag_invocable<schedule_bulk_t,
+                                                    Scheduler const&,
+                                                    Operations&>);
+    tag_invoke(*this, sched, ops);
+  }
+
+  // Schedulers without a batch path get one start() per operation.
+  template <class Scheduler, operation_range Operations>
+  requires scheduler<Scheduler const&>
+  void operator()(Scheduler const& /*unused*/,
+                  Operations&& ops) const noexcept {
+    for (auto& op : ops) {
+      execution::start(op);
+    }
+  }
+};
+
+}  // namespace _schedule_bulk
+
+// Starts every operation state in ops, each of which should have been
+// connected from schedule(sched). Schedulers customize it to enqueue the
+// whole batch at once and wake only as many workers as it can keep busy;
+// operations connected from a different scheduler of the same type are
+// started one by one on their own.
+inline constexpr _schedule_bulk::schedule_bulk_t schedule_bulk{};
+
+}  // namespace execution
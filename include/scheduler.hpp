@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <concepts>
+#include <environment.hpp>
+#include <sender.hpp>
+#include <tag_invoke.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace execution {
+
+namespace _schedule {
+
+struct schedule_t {
+  template <class Scheduler>
+  requires functional::tag_invocable<schedule_t, Scheduler>
+  auto operator()(Scheduler&& scheduler) const
+      noexcept(functional::nothrow_tag_invocable<schedule_t, Scheduler>)
+          -> functional::tag_invoke_result_t<schedule_t, Scheduler> {
+    return tag_invoke(*this, std::forward<Scheduler>(scheduler));
+  }
+};
+
+}  // namespace _schedule
+
+inline constexpr _schedule::schedule_t schedule{};
+
+template <typename Scheduler>
+concept scheduler = std::copy_constructible<std::remove_cvref_t<Scheduler>> &&
+    std::equality_comparable<std::remove_cvref_t<Scheduler>> &&
+    requires(Scheduler&& sched) {
+  schedule(std::forward<Scheduler>(sched));
+};
+
+template <typename Scheduler>
+using schedule_result_t = decltype(schedule(std::declval<Scheduler>()));
+
+namespace _get_scheduler {
+
+struct get_scheduler_t {
+  template <class Env>
+  requires functional::tag_invocable<get_scheduler_t, Env const&>
+  auto operator()(Env const& env) const
+      noexcept(functional::nothrow_tag_invocable<get_scheduler_t, Env const&>)
+          -> functional::tag_invoke_result_t<get_scheduler_t, Env const&> {
+    using result_t =
+        functional::tag_invoke_result_t<get_scheduler_t, Env const&>;
+    static_assert(scheduler<result_t>);
+    return tag_invoke(*this, env);
+  }
+
+  friend constexpr auto tag_invoke(
+      functional::tag_t<forwarding_env_query> /*unused*/,
+      get_scheduler_t /*unused*/) noexcept -> bool {
+    return true;
+  }
+};
+
+}  // namespace _get_scheduler
+
+inline constexpr _get_scheduler::get_scheduler_t get_scheduler{};
+
+}  // namespace execution
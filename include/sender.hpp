@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <operation_state.hpp>
+#include <receiver.hpp>
+#include <tag_invoke.hpp>
+#include <utility>
+
+namespace execution {
+
+namespace _connect {
+
+struct connect_t {
+  template <class Sender, class Receiver>
+  requires receiver<Receiver> &&
+      functional::tag_invocable<connect_t, Sender, Receiver>
+  auto operator()(Sender&& sender, Receiver&& receiver) const
+      noexcept(functional::nothrow_tag_invocable<connect_t, Sender, Receiver>)
+          -> functional::tag_invoke_result_t<connect_t, Sender, Receiver> {
+    using result_t =
+        functional::tag_invoke_result_t<connect_t, Sender, Receiver>;
+    static_assert(operation_state<result_t>);
+    return tag_invoke(*this, std::forward<Sender>(sender),
+                      std::forward<Receiver>(receiver));
+  }
+};
+
+}  // namespace _connect
+
+inline constexpr _connect::connect_t connect{};
+
+template <typename Sender, typename Receiver>
+concept sender_to = receiver<Receiver> &&
+    requires(Sender&& sender, Receiver&& receiver) {
+  connect(std::forward<Sender>(sender), std::forward<Receiver>(receiver));
+};
+
+template <typename Sender, typename Receiver>
+using connect_result_t =
+    decltype(connect(std::declval<Sender>(), std::declval<Receiver>()));
+
+}  // namespace execution
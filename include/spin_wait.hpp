@@ -26,6 +26,7 @@
 
 #include <cstdint>
 #include <iostream>
+#include <stop_metrics.hpp>
 #include <thread>
 namespace execution {
 class spin_wait {
@@ -38,8 +39,10 @@ class spin_wait {
   void wait() noexcept {
     if (count_ < yield_threshold) {
       ++count_;
+      stop_metrics::add(stop_metric::spin_iterations);
       // TODO: _mm_pause (for signaling processor we are in spin_loop)
     } else {
+      stop_metrics::add(stop_metric::spin_yields);
       std::this_thread::yield();
     }
   }
@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Define to 1 to count contention and cancellation events inside
+// in_place_stop_source and spin_wait. Must be the same in every translation
+// unit of a program. When 0, every counter update compiles to nothing.
+#ifndef EXECUTION_ENABLE_STOP_METRICS
+#define EXECUTION_ENABLE_STOP_METRICS 0
+#endif
+
+namespace execution {
+
+enum class stop_metric : std::uint8_t {
+  lock_acquisitions,
+  cas_failures,
+  spin_iterations,
+  spin_yields,
+  callbacks_registered,
+  callbacks_executed,
+  remove_callback_waits,
+  remove_callback_wait_ns,
+  stop_requests,
+  request_stop_ns,
+};
+
+struct stop_metrics_snapshot {
+  std::uint64_t lock_acquisitions = 0;
+  std::uint64_t cas_failures = 0;
+  std::uint64_t spin_iterations = 0;
+  std::uint64_t spin_yields = 0;
+  std::uint64_t callbacks_registered = 0;
+  std::uint64_t callbacks_executed = 0;
+  std::uint64_t remove_callback_waits = 0;
+  std::uint64_t remove_callback_wait_ns = 0;
+  std::uint64_t stop_requests = 0;
+  std::uint64_t request_stop_ns = 0;
+};
+
+// Process wide counters. Updates go to one of several cache line sized shards
+// chosen per thread, so measuring contention does not add much of its own.
+class stop_metrics {
+ public:
+  static constexpr bool enabled = EXECUTION_ENABLE_STOP_METRICS != 0;
+
+  static void add(stop_metric metric, std::uint64_t n = 1) noexcept {
+    if constexpr (enabled) {
+      local_shard()
+          .counters[static_cast<std::size_t>(metric)]
+          .fetch_add(n, std::memory_order_relaxed);
+    }
+  }
+
+  [[nodiscard]] static auto snapshot() noexcept -> stop_metrics_snapshot {
+    stop_metrics_snapshot result;
+    if constexpr (enabled) {
+      auto get = [](stop_metric metric) {
+        std::uint64_t total = 0;
+        for (auto const& s : shards()) {
+          total += s.counters[static_cast<std::size_t>(metric)].load(
+              std::memory_order_relaxed);
+        }
+        return total;
+      };
+      result.lock_acquisitions = get(stop_metric::lock_acquisitions);
+      result.cas_failures = get(stop_metric::cas_failures);
+      result.spin_iterations = get(stop_metric::spin_iterations);
+      result.spin_yields = get(stop_metric::spin_yields);
+      result.callbacks_registered = get(stop_metric::callbacks_registered);
+      result.callbacks_executed = get(stop_metric::callbacks_executed);
+      result.remove_callback_waits = get(stop_metric::remove_callback_waits);
+      result.remove_callback_wait_ns =
+          get(stop_metric::remove_callback_wait_ns);
+      result.stop_requests = get(stop_metric::stop_requests);
+      result.request_stop_ns = get(stop_metric::request_stop_ns);
+    }
+    return result;
+  }
+
+  static void reset() noexcept {
+    if constexpr (enabled) {
+      for (auto& s : shards()) {
+        for (auto& counter : s.counters) {
+          counter.store(0, std::memory_order_relaxed);
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr std::size_t metric_count =
+      static_cast<std::size_t>(stop_metric::request_stop_ns) + 1;
+  static constexpr std::size_t shard_count = 16;
+
+  struct alignas(64) shard {
+    std::array<std::atomic<std::uint64_t>, metric_count> counters{};
+  };
+
+  static auto shards() noexcept -> std::array<shard, shard_count>& {
+    static std::array<shard, shard_count> instance{};
+    return instance;
+  }
+
+  static auto local_shard() noexcept -> shard& {
+    static std::atomic<std::size_t> next{0};
+    static thread_local std::size_t index =
+        next.fetch_add(1, std::memory_order_relaxed) % shard_count;
+    return shards()[index];
+  }
+};
+
+// Adds the time between construction and destruction to a nanosecond counter.
+class stop_metrics_timer {
+ public:
+  explicit stop_metrics_timer(stop_metric metric) noexcept : metric_(metric) {
+    if constexpr (stop_metrics::enabled) {
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  stop_metrics_timer(const stop_metrics_timer&) = delete;
+  stop_metrics_timer(stop_metrics_timer&&) = delete;
+  auto operator=(const stop_metrics_timer&) -> stop_metrics_timer& = delete;
+  auto operator=(stop_metrics_timer&&) -> stop_metrics_timer& = delete;
+
+  ~stop_metrics_timer() {
+    if constexpr (stop_metrics::enabled) {
+      auto const elapsed = std::chrono::steady_clock::now() - start_;
+      stop_metrics::add(
+          metric_, static_cast<std::uint64_t>(
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           elapsed)
+                           .count()));
+    }
+  }
+
+ private:
+  stop_metric metric_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace execution
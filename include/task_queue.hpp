@@ -0,0 +1,193 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <atomic>
+
+namespace execution {
+
+class task_queue;
+class atomic_task_inbox;
+
+// Node of an intrusive task queue. Operation states that get enqueued by a
+// scheduler derive from it, so scheduling work never allocates.
+class task_base {
+ public:
+  void execute() noexcept { this->execute_(this); }
+
+ protected:
+  using execute_fn = void(task_base* task) noexcept;
+
+  explicit task_base(execute_fn* fn) noexcept : execute_(fn) {}
+
+ private:
+  friend task_queue;
+  friend atomic_task_inbox;
+
+  execute_fn* execute_;
+  task_base* next_ = nullptr;
+};
+
+// Singly linked FIFO of tasks. Not synchronized.
+class task_queue {
+ public:
+  task_queue() noexcept = default;
+
+  task_queue(const task_queue&) = delete;
+  auto operator=(const task_queue&) -> task_queue& = delete;
+
+  task_queue(task_queue&& other) noexcept
+      : head_(other.head_), tail_(other.tail_) {
+    other.head_ = other.tail_ = nullptr;
+  }
+
+  auto operator=(task_queue&& other) noexcept -> task_queue& {
+    head_ = other.head_;
+    tail_ = other.tail_;
+    other.head_ = other.tail_ = nullptr;
+    return *this;
+  }
+
+  ~task_queue() = default;
+
+  [[nodiscard]] auto empty() const noexcept -> bool {
+    return head_ == nullptr;
+  }
+
+  void push_back(task_base* task) noexcept {
+    task->next_ = nullptr;
+    if (tail_ == nullptr) {
+      head_ = task;
+    } else {
+      tail_->next_ = task;
+    }
+    tail_ = task;
+  }
+
+  void push_front(task_base* task) noexcept {
+    task->next_ = head_;
+    head_ = task;
+    if (tail_ == nullptr) {
+      tail_ = task;
+    }
+  }
+
+  // Moves all of other's tasks to the back of this queue.
+  void append(task_queue&& other) noexcept {
+    if (other.head_ == nullptr) {
+      return;
+    }
+    if (tail_ == nullptr) {
+      head_ = other.head_;
+    } else {
+      tail_->next_ = other.head_;
+    }
+    tail_ = other.tail_;
+    other.head_ = other.tail_ = nullptr;
+  }
+
+  auto pop_front() noexcept -> task_base* {
+    auto* task = head_;
+    if (task != nullptr) {
+      head_ = task->next_;
+      if (head_ == nullptr) {
+        tail_ = nullptr;
+      }
+      task->next_ = nullptr;
+    }
+    return task;
+  }
+
+ private:
+  task_base* head_ = nullptr;
+  task_base* tail_ = nullptr;
+};
+
+// Tasks pushed by any number of threads without locking. A consumer takes
+// all of them at once, in the order they were pushed.
+class atomic_task_inbox {
+ public:
+  atomic_task_inbox() noexcept = default;
+
+  atomic_task_inbox(const atomic_task_inbox&) = delete;
+  atomic_task_inbox(atomic_task_inbox&&) = delete;
+  auto operator=(const atomic_task_inbox&) -> atomic_task_inbox& = delete;
+  auto operator=(atomic_task_inbox&&) -> atomic_task_inbox& = delete;
+
+  ~atomic_task_inbox() = default;
+
+  [[nodiscard]] auto empty() const noexcept -> bool {
+    return head_.load(std::memory_order_relaxed) == nullptr;
+  }
+
+  void push(task_base* task) noexcept {
+    auto* head = head_.load(std::memory_order_relaxed);
+    do {
+      task->next_ = head;
+    } while (!head_.compare_exchange_weak(head, task,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+
+  // Pushes all tasks with a single atomic operation. take_all() returns
+  // them in queue order.
+  void push_all(task_queue tasks) noexcept {
+    // Reverse the batch into stack order, newest first.
+    task_base* first = nullptr;
+    task_base* last = nullptr;
+    while (auto* task = tasks.pop_front()) {
+      task->next_ = first;
+      if (first == nullptr) {
+        last = task;
+      }
+      first = task;
+    }
+    if (first == nullptr) {
+      return;
+    }
+    auto* head = head_.load(std::memory_order_relaxed);
+    do {
+      last->next_ = head;
+    } while (!head_.compare_exchange_weak(head, first,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+
+  auto take_all() noexcept -> task_queue {
+    auto* task = head_.exchange(nullptr, std::memory_order_acquire);
+    task_queue tasks;
+    // The inbox is a stack, newest first.
+    while (task != nullptr) {
+      auto* next = task->next_;
+      tasks.push_front(task);
+      task = next;
+    }
+    return tasks;
+  }
+
+ private:
+  std::atomic<task_base*> head_{nullptr};
+};
+
+}  // namespace execution
@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <concepts>
+#include <environment.hpp>
+#include <exception>
+#include <functional>
+#include <receiver.hpp>
+#include <sender.hpp>
+#include <tag_invoke.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace execution {
+
+namespace _then {
+
+template <class Receiver, class F>
+class receiver_t {
+ public:
+  receiver_t(Receiver out, F f) noexcept(
+      std::is_nothrow_move_constructible_v<Receiver>&&
+          std::is_nothrow_move_constructible_v<F>)
+      : out_(std::move(out)), f_(std::move(f)) {}
+
+  // Self is deduced, rather than spelled receiver_t&&, so that the
+  // constraints are not checked for calls with other receiver types.
+  template <class Self, class... Values>
+  requires std::same_as<Self, receiver_t> && std::invocable<F, Values...>
+  friend void tag_invoke(functional::tag_t<set_value> /*unused*/, Self&& self,
+                         Values&&... values) noexcept {
+    if constexpr (std::is_nothrow_invocable_v<F, Values...>) {
+      self.complete(std::forward<Values>(values)...);
+    } else {
+      try {
+        self.complete(std::forward<Values>(values)...);
+      } catch (...) {
+        set_error(std::move(self.out_), std::current_exception());
+      }
+    }
+  }
+
+  template <class Self, class Error>
+  requires std::same_as<Self, receiver_t> &&
+      std::invocable<functional::tag_t<set_error>, Receiver, Error>
+  friend void tag_invoke(functional::tag_t<set_error> /*unused*/, Self&& self,
+                         Error&& error) noexcept {
+    set_error(std::move(self.out_), std::forward<Error>(error));
+  }
+
+  template <class Self>
+  requires std::same_as<Self, receiver_t> &&
+      std::invocable<functional::tag_t<set_stopped>, Receiver>
+  friend void tag_invoke(functional::tag_t<set_stopped> /*unused*/,
+                         Self&& self) noexcept {
+    set_stopped(std::move(self.out_));
+  }
+
+  friend auto tag_invoke(functional::tag_t<get_env> /*unused*/,
+                         receiver_t const& self) {
+    return forward_env(execution::get_env(self.out_));
+  }
+
+ private:
+  template <class... Values>
+  void complete(Values&&... values) {
+    if constexpr (std::is_void_v<std::invoke_result_t<F, Values...>>) {
+      std::invoke(std::move(f_), std::forward<Values>(values)...);
+      set_value(std::move(out_));
+    } else {
+      set_value(std::move(out_),
+                std::invoke(std::move(f_), std::forward<Values>(values)...));
+    }
+  }
+
+  Receiver out_;
+  F f_;
+};
+
+template <class Sender, class F>
+class sender_t {
+ public:
+  sender_t(Sender sender, F f) noexcept(
+      std::is_nothrow_move_constructible_v<Sender>&&
+          std::is_nothrow_move_constructible_v<F>)
+      : sender_(std::move(sender)), f_(std::move(f)) {}
+
+  template <class Self, class Receiver>
+  requires std::same_as<std::remove_cvref_t<Self>, sender_t> &&
+      receiver<Receiver> &&
+      sender_to<decltype((std::declval<Self>().sender_)),
+                receiver_t<std::remove_cvref_t<Receiver>, F>>
+  friend auto tag_invoke(functional::tag_t<connect> /*unused*/, Self&& self,
+                         Receiver&& receiver) {
+    return connect(std::forward<Self>(self).sender_,
+                   receiver_t<std::remove_cvref_t<Receiver>, F>{
+                       std::forward<Receiver>(receiver),
+                       std::forward<Self>(self).f_});
+  }
+
+ private:
+  Sender sender_;
+  F f_;
+};
+
+struct then_t {
+  template <class Sender, class F>
+  requires functional::tag_invocable<then_t, Sender, F>
+  auto operator()(Sender&& sender, F&& f) const
+      noexcept(functional::nothrow_tag_invocable<then_t, Sender, F>)
+          -> functional::tag_invoke_result_t<then_t, Sender, F> {
+    return tag_invoke(*this, std::forward<Sender>(sender), std::forward<F>(f));
+  }
+
+  template <class Sender, class F>
+  auto operator()(Sender&& sender, F&& f) const
+      -> sender_t<std::remove_cvref_t<Sender>, std::remove_cvref_t<F>> {
+    return {std::forward<Sender>(sender), std::forward<F>(f)};
+  }
+};
+
+}  // namespace _then
+
+inline constexpr _then::then_t then{};
+
+}  // namespace execution
@@ -0,0 +1,297 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <environment.hpp>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <tag_invoke.hpp>
+#include <thread>
+#include <vector>
+
+namespace execution {
+
+enum class trace_event_kind : std::uint8_t { started, completed, cancelled };
+
+struct trace_event {
+  const char* name = nullptr;  // Must point to a string with static storage.
+  std::uintptr_t operation = 0;
+  std::int64_t timestamp_ns = 0;
+  trace_event_kind kind = trace_event_kind::started;
+};
+
+// Single producer, single consumer ring of trace events. The owning thread
+// pushes, the thread dumping the trace consumes. Events pushed while the ring
+// is full are dropped and counted instead of blocking the producer.
+template <std::size_t Capacity>
+class trace_ring_buffer {
+  static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+ public:
+  trace_ring_buffer() noexcept = default;
+
+  trace_ring_buffer(const trace_ring_buffer&) = delete;
+  trace_ring_buffer(trace_ring_buffer&&) = delete;
+  auto operator=(const trace_ring_buffer&) -> trace_ring_buffer& = delete;
+  auto operator=(trace_ring_buffer&&) -> trace_ring_buffer& = delete;
+
+  ~trace_ring_buffer() = default;
+
+  auto try_push(trace_event const& event) noexcept -> bool {
+    auto const tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    events_[tail & mask] = event;  // NOLINT
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <std::invocable<trace_event const&> F>
+  auto consume(F&& f) -> std::size_t {
+    auto head = head_.load(std::memory_order_relaxed);
+    auto const tail = tail_.load(std::memory_order_acquire);
+    auto const count = tail - head;
+    for (; head != tail; ++head) {
+      f(events_[head & mask]);  // NOLINT
+    }
+    head_.store(head, std::memory_order_release);
+    return count;
+  }
+
+  [[nodiscard]] auto dropped() const noexcept -> std::uint64_t {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr std::size_t mask = Capacity - 1;
+
+  alignas(64) std::atomic<std::size_t> head_{0};
+  alignas(64) std::atomic<std::size_t> tail_{0};
+  std::atomic<std::uint64_t> dropped_{0};
+  std::array<trace_event, Capacity> events_{};
+};
+
+// Collects trace events recorded by any number of threads. Every thread gets
+// its own ring buffer the first time it records into a tracer; after that,
+// record() neither locks nor allocates while the thread records into at most
+// cache_size tracers.
+class tracer {
+ public:
+  static constexpr std::size_t buffer_capacity = std::size_t{1} << 14U;
+  static constexpr std::size_t cache_size = 8;
+  using buffer_type = trace_ring_buffer<buffer_capacity>;
+
+  tracer() noexcept : id_(next_id()) {}
+
+  tracer(const tracer&) = delete;
+  tracer(tracer&&) = delete;
+  auto operator=(const tracer&) -> tracer& = delete;
+  auto operator=(tracer&&) -> tracer& = delete;
+
+  ~tracer() = default;
+
+  void record(trace_event_kind kind, const char* name,
+              const void* operation) noexcept {
+    auto* buffer = local_buffer();
+    if (buffer == nullptr) {
+      return;
+    }
+    auto const now = std::chrono::steady_clock::now().time_since_epoch();
+    (void)buffer->events.try_push(trace_event{
+        name, reinterpret_cast<std::uintptr_t>(operation),  // NOLINT
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(),
+        kind});
+  }
+
+  // Invokes f(thread_index, event) for every event recorded since the last
+  // drain. Events of one thread are visited in the order they were recorded.
+  template <std::invocable<std::uint32_t, trace_event const&> F>
+  void drain(F&& f) {
+    std::lock_guard lock{mutex_};
+    for (auto& buffer : buffers_) {
+      buffer->events.consume(
+          [&](trace_event const& event) { f(buffer->thread_index, event); });
+    }
+  }
+
+  [[nodiscard]] auto dropped() const -> std::uint64_t {
+    std::lock_guard lock{mutex_};
+    std::uint64_t total = 0;
+    for (auto const& buffer : buffers_) {
+      total += buffer->events.dropped();
+    }
+    return total;
+  }
+
+ private:
+  struct thread_buffer {
+    std::thread::id thread;
+    std::uint32_t thread_index;
+    buffer_type events;
+  };
+
+  static auto next_id() noexcept -> std::uint64_t {
+    static std::atomic<std::uint64_t> id{0};
+    return id.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  // Looks the buffer up in a per-thread cache of the tracers the thread
+  // recorded into last. Misses replace the entries round robin.
+  auto local_buffer() noexcept -> thread_buffer* {
+    struct cache_entry {
+      std::uint64_t tracer_id = 0;
+      thread_buffer* buffer = nullptr;
+    };
+    struct buffer_cache {
+      std::array<cache_entry, cache_size> entries{};
+      std::size_t next = 0;
+    };
+    static thread_local buffer_cache cache;
+    for (auto const& entry : cache.entries) {
+      if (entry.tracer_id == id_) {
+        return entry.buffer;
+      }
+    }
+    auto& entry = cache.entries[cache.next++ % cache_size];  // NOLINT
+    entry = cache_entry{id_, register_thread()};
+    return entry.buffer;
+  }
+
+  auto register_thread() noexcept -> thread_buffer* {
+    auto const thread = std::this_thread::get_id();
+    try {
+      std::lock_guard lock{mutex_};
+      for (auto& buffer : buffers_) {
+        if (buffer->thread == thread) {
+          return buffer.get();
+        }
+      }
+      auto const index = static_cast<std::uint32_t>(buffers_.size());
+      buffers_.push_back(std::unique_ptr<thread_buffer>(
+          new thread_buffer{thread, index, {}}));  // NOLINT
+      return buffers_.back().get();
+    } catch (...) {
+      // Tracing is best effort, never fail the traced operation.
+      return nullptr;
+    }
+  }
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<thread_buffer>> buffers_;
+  std::uint64_t id_;
+};
+
+namespace _get_tracer {
+
+struct get_tracer_t {
+  template <class Env>
+  requires functional::tag_invocable<get_tracer_t, Env const&>
+  auto operator()(Env const& env) const
+      noexcept(functional::nothrow_tag_invocable<get_tracer_t, Env const&>)
+          -> functional::tag_invoke_result_t<get_tracer_t, Env const&> {
+    return tag_invoke(*this, env);
+  }
+
+  friend constexpr auto tag_invoke(
+      functional::tag_t<forwarding_env_query> /*unused*/,
+      get_tracer_t /*unused*/) noexcept -> bool {
+    return true;
+  }
+};
+
+}  // namespace _get_tracer
+
+inline constexpr _get_tracer::get_tracer_t get_tracer{};
+
+template <typename Env>
+concept tracing_env = functional::tag_invocable<functional::tag_t<get_tracer>,
+                                                Env const&>;
+
+// Records an event into the tracer of env. For environments without a tracer
+// this is an empty function, so instrumentation costs nothing.
+template <typename Env>
+void trace(Env const& env, trace_event_kind kind, const char* name,
+           const void* operation) noexcept {
+  if constexpr (tracing_env<Env>) {
+    get_tracer(env).record(kind, name, operation);
+  }
+}
+
+namespace detail {
+
+inline void write_json_string(std::ostream& os, const char* str) {
+  os << '"';
+  for (; str != nullptr && *str != '\0'; ++str) {  // NOLINT
+    if (*str == '"' || *str == '\\') {
+      os << '\\';
+    }
+    os << *str;
+  }
+  os << '"';
+}
+
+}  // namespace detail
+
+// Drains tr and writes its events as Chrome trace event JSON, loadable in
+// chrome://tracing and Perfetto. Every operation becomes an async span keyed
+// by its address, ended by either a complete or a cancel event.
+inline void write_chrome_trace(tracer& tr, std::ostream& os) {
+  os << R"({"displayTimeUnit":"ns","traceEvents":[)";
+  bool first = true;
+  tr.drain([&](std::uint32_t thread_index, trace_event const& event) {
+    if (!first) {
+      os << ',';
+    }
+    first = false;
+    os << R"({"name":)";
+    detail::write_json_string(os, event.name);
+    os << R"(,"cat":"execution","ph":")"
+       << (event.kind == trace_event_kind::started ? 'b' : 'e')
+       << R"(","id":")" << std::hex << "0x" << event.operation << std::dec
+       << R"(","pid":1,"tid":)" << thread_index << R"(,"ts":)"
+       << event.timestamp_ns / 1000 << '.';
+    auto const fraction = event.timestamp_ns % 1000;
+    os << (fraction < 100 ? "0" : "") << (fraction < 10 ? "0" : "")
+       << fraction;
+    if (event.kind != trace_event_kind::started) {
+      os << R"(,"args":{"result":")"
+         << (event.kind == trace_event_kind::completed ? "complete" : "cancel")
+         << R"("})";
+    }
+    os << '}';
+  });
+  os << "]}\n";
+}
+
+}  // namespace execution
@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <cstddef>
+#include <operation_state.hpp>
+#include <receiver.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <tag_invoke.hpp>
+#include <task_queue.hpp>
+#include <type_traits>
+#include <utility>
+
+namespace execution {
+
+// Scheduler that runs work inline on the thread that starts it, as long as
+// fewer than max_depth of its operations are nested on the stack. Deeper
+// operations are queued and run by the outermost one once the stack has
+// unwound, so recursive chains run in bounded stack without allocating.
+class trampoline_scheduler {
+  class state {
+   public:
+    static void submit(task_base* task, std::size_t maxDepth) noexcept {
+      auto* current = current_;
+      if (current == nullptr) {
+        state outermost;
+        current_ = &outermost;
+        task->execute();
+        while (auto* next = outermost.pending_.pop_front()) {
+          outermost.depth_ = 1;
+          next->execute();
+        }
+        current_ = nullptr;
+      } else if (current->depth_ < maxDepth) {
+        ++current->depth_;
+        task->execute();
+        --current->depth_;
+      } else {
+        current->pending_.push_back(task);
+      }
+    }
+
+   private:
+    static inline thread_local state* current_ = nullptr;
+
+    std::size_t depth_ = 1;
+    task_queue pending_;
+  };
+
+  template <class Receiver>
+  class operation : task_base {
+   public:
+    operation(std::size_t maxDepth, Receiver&& receiver) noexcept(
+        std::is_nothrow_move_constructible_v<Receiver>)
+        : task_base(&operation::execute_impl),
+          maxDepth_(maxDepth),
+          receiver_(std::move(receiver)) {}
+
+    operation(const operation&) = delete;
+    operation(operation&&) = delete;
+    auto operator=(const operation&) -> operation& = delete;
+    auto operator=(operation&&) -> operation& = delete;
+
+    ~operation() = default;
+
+    friend void tag_invoke(functional::tag_t<start> /*unused*/,
+                           operation& op) noexcept {
+      op.submit();
+    }
+
+   private:
+    void submit() noexcept { state::submit(this, maxDepth_); }
+
+    static void execute_impl(task_base* task) noexcept {
+      auto& op = *static_cast<operation*>(task);
+      set_value(std::move(op.receiver_));
+    }
+
+    std::size_t maxDepth_;
+    Receiver receiver_;
+  };
+
+  class sender {
+   public:
+    explicit sender(std::size_t maxDepth) noexcept : maxDepth_(maxDepth) {}
+
+    template <class Receiver>
+    requires receiver<Receiver> &&
+        std::invocable<functional::tag_t<set_value>,
+                       std::remove_cvref_t<Receiver>>
+    friend auto tag_invoke(functional::tag_t<connect> /*unused*/,
+                           sender const& s, Receiver&& r)
+        -> operation<std::remove_cvref_t<Receiver>> {
+      return {s.maxDepth_, std::forward<Receiver>(r)};
+    }
+
+   private:
+    std::size_t maxDepth_;
+  };
+
+ public:
+  static constexpr std::size_t default_max_depth = 16;
+
+  explicit trampoline_scheduler(
+      std::size_t maxDepth = default_max_depth) noexcept
+      : maxDepth_(maxDepth == 0 ? 1 : maxDepth) {}
+
+  friend auto operator==(trampoline_scheduler const& a,
+                         trampoline_scheduler const& b) noexcept
+      -> bool = default;
+
+  friend auto tag_invoke(functional::tag_t<schedule> /*unused*/,
+                         trampoline_scheduler const& s) noexcept -> sender {
+    return sender{s.maxDepth_};
+  }
+
+ private:
+  std::size_t maxDepth_;
+};
+
+}  // namespace execution
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <atomic>
+#include <environment.hpp>
+#include <receiver.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <tag_invoke.hpp>
+#include <thread>
+
+// Keeps the worker that runs it busy until opened.
+struct gate_receiver {
+  std::atomic<bool>* entered;
+  std::atomic<bool>* open;
+  std::atomic<bool>* left;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         gate_receiver&& r) noexcept {
+    r.entered->store(true);
+    while (!r.open->load()) {
+      std::this_thread::yield();
+    }
+    r.left->store(true);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         gate_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+// Occupies a worker of the scheduler's pool from construction until open is
+// set, or until destruction.
+template <class Scheduler>
+struct gate {
+  std::atomic<bool> entered{false};
+  std::atomic<bool> open{false};
+  std::atomic<bool> left{false};
+  execution::connect_result_t<execution::schedule_result_t<Scheduler>,
+                              gate_receiver>
+      op;
+
+  explicit gate(Scheduler sched)
+      : op(execution::connect(execution::schedule(sched),
+                              gate_receiver{&entered, &open, &left})) {
+    execution::start(op);
+    while (!entered.load()) {
+      std::this_thread::yield();
+    }
+  }
+
+  gate(const gate&) = delete;
+  gate(gate&&) = delete;
+  auto operator=(const gate&) -> gate& = delete;
+  auto operator=(gate&&) -> gate& = delete;
+
+  ~gate() {
+    open.store(true);
+    while (!left.load()) {
+      std::this_thread::yield();
+    }
+  }
+};
@@ -0,0 +1,176 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <in_place_stop_token.hpp>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using execution::in_place_stop_batching;
+using execution::in_place_stop_callback;
+using execution::in_place_stop_runner;
+using execution::in_place_stop_source;
+
+namespace {
+
+struct counting_callback {
+  std::atomic<int>* count;
+  void operator()() const noexcept { count->fetch_add(1); }
+};
+
+using counting_stop_callback = in_place_stop_callback<counting_callback>;
+
+}  // namespace
+
+TEST_CASE("request_stop runs every callback once") {
+  in_place_stop_source source;
+  std::atomic<int> count{0};
+  std::deque<counting_stop_callback> callbacks;
+  for (int i = 0; i < 10; ++i) {
+    callbacks.emplace_back(source.get_token(), counting_callback{&count});
+  }
+  REQUIRE_FALSE(source.request_stop());
+  REQUIRE(source.request_stop());
+  REQUIRE(source.stop_requested());
+  REQUIRE(count == 10);
+
+  counting_stop_callback late{source.get_token(), counting_callback{&count}};
+  REQUIRE(count == 11);
+}
+
+TEST_CASE("batched request_stop runs every callback once") {
+  in_place_stop_source source;
+  std::atomic<int> count{0};
+  std::deque<counting_stop_callback> callbacks;
+  for (int i = 0; i < 100; ++i) {
+    callbacks.emplace_back(source.get_token(), counting_callback{&count});
+  }
+  REQUIRE_FALSE(source.request_stop(in_place_stop_batching{7, 1}));
+  REQUIRE(source.request_stop(in_place_stop_batching{}));
+  REQUIRE(count == 100);
+}
+
+TEST_CASE("callback removing pending callbacks of its own batch") {
+  in_place_stop_source source;
+  std::atomic<int> count{0};
+  std::optional<counting_stop_callback> other;
+  std::optional<in_place_stop_callback<std::function<void()>>> self;
+  other.emplace(source.get_token(), counting_callback{&count});
+  // Registered last, so executed first.
+  self.emplace(source.get_token(), [&] {
+    other.reset();
+    self.reset();
+  });
+  REQUIRE_FALSE(source.request_stop(in_place_stop_batching{}));
+  REQUIRE(count == 0);
+  REQUIRE_FALSE(other.has_value());
+  REQUIRE_FALSE(self.has_value());
+}
+
+TEST_CASE("parallel request_stop completes callbacks before returning") {
+  in_place_stop_source source;
+  std::atomic<int> count{0};
+  std::deque<counting_stop_callback> callbacks;
+  for (int i = 0; i < 1000; ++i) {
+    callbacks.emplace_back(source.get_token(), counting_callback{&count});
+  }
+  std::vector<std::thread> workers;
+  REQUIRE_FALSE(source.request_stop(
+      in_place_stop_batching{16, 4}, [&](in_place_stop_runner runner) {
+        workers.emplace_back(std::move(runner));
+      }));
+  REQUIRE(workers.size() == 3);
+  REQUIRE(count == 1000);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+TEST_CASE("removing a callback executing on a runner waits for it") {
+  in_place_stop_source source;
+  std::atomic<bool> started{false};
+  std::atomic<bool> finished{false};
+  auto slow = [&]() noexcept {
+    started.store(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    finished.store(true);
+  };
+  std::optional<in_place_stop_callback<decltype(slow)>> cb;
+  cb.emplace(source.get_token(), slow);
+  std::thread stopper{
+      [&] { source.request_stop(in_place_stop_batching{}); }};
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+  cb.reset();
+  REQUIRE(finished.load());
+  stopper.join();
+}
+
+TEST_CASE("runners not started before the requester finished are abandoned") {
+  std::atomic<int> count{0};
+  std::vector<in_place_stop_runner> runners;
+  {
+    in_place_stop_source source;
+    std::deque<counting_stop_callback> callbacks;
+    for (int i = 0; i < 100; ++i) {
+      callbacks.emplace_back(source.get_token(), counting_callback{&count});
+    }
+    // Like a pool whose only worker is the requesting thread.
+    REQUIRE_FALSE(source.request_stop(
+        in_place_stop_batching{8, 4}, [&](in_place_stop_runner runner) {
+          runners.push_back(std::move(runner));
+        }));
+    REQUIRE(count == 100);
+  }
+  REQUIRE(runners.size() == 3);
+  // The source is gone; late runners do nothing, unused ones are dropped.
+  runners[0]();
+  runners[0]();
+  runners.clear();
+}
+
+TEST_CASE("removing a callback pending in another thread's batch drops it") {
+  in_place_stop_source source;
+  std::atomic<int> count{0};
+  std::optional<counting_stop_callback> pending;
+  std::optional<in_place_stop_callback<std::function<void()>>> first;
+  pending.emplace(source.get_token(), counting_callback{&count});
+  // Registered last, so executed first, with pending in the same batch.
+  first.emplace(source.get_token(), [&] {
+    // Waiting for the pending callback to run would deadlock here.
+    std::thread remover{[&] { pending.reset(); }};
+    remover.join();
+  });
+  REQUIRE_FALSE(source.request_stop(in_place_stop_batching{2, 1}));
+  REQUIRE(count == 0);
+  REQUIRE_FALSE(pending.has_value());
+}
@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <environment.hpp>
+#include <mutex>
+#include <priority.hpp>
+#include <receiver.hpp>
+#include <tag_invoke.hpp>
+#include <thread>
+#include <vector>
+
+// Receivers shared by the scheduler tests.
+
+struct priority_env {
+  execution::priority value;
+
+  friend auto tag_invoke(functional::tag_t<execution::get_priority> /*unused*/,
+                         priority_env const& env) noexcept
+      -> execution::priority {
+    return env.value;
+  }
+};
+
+// Ids of completed operations, in completion order.
+struct execution_log {
+  std::mutex mutex;
+  std::vector<std::size_t> order;
+  std::atomic<std::size_t> count{0};
+
+  void add(std::size_t id) {
+    {
+      std::lock_guard lock{mutex};
+      order.push_back(id);
+    }
+    count.fetch_add(1, std::memory_order_release);
+  }
+
+  void wait_for(std::size_t expected) const {
+    while (count.load(std::memory_order_acquire) != expected) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+// Records its id when it runs. With an Env that has no get_priority the
+// scheduler's fallback applies.
+template <class Env>
+struct basic_logging_receiver {
+  execution_log* log;
+  std::size_t id;
+  Env env;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         basic_logging_receiver&& r) noexcept {
+    r.log->add(r.id);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         basic_logging_receiver const& r) noexcept -> Env {
+    return r.env;
+  }
+};
+
+using logging_receiver = basic_logging_receiver<priority_env>;
+using fallback_receiver = basic_logging_receiver<execution::empty_env>;
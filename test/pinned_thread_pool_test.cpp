@@ -0,0 +1,239 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <optional>
+#include <pinned_thread_pool.hpp>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using execution::pinned_thread_pool;
+
+namespace {
+
+struct counting_receiver {
+  std::atomic<int>* count;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         counting_receiver&& r) noexcept {
+    r.count->fetch_add(1);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         counting_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+struct core_receiver {
+  pinned_thread_pool* pool;
+  std::atomic<bool>* on_expected_core;
+  pinned_thread_pool::scheduler expected;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         core_receiver&& r) noexcept {
+    auto const current = execution::get_scheduler(r.pool->get_env());
+    r.on_expected_core->store(current == r.expected);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         core_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+// Reports the core it runs on, then blocks it until released.
+struct blocking_receiver {
+  pinned_thread_pool* pool;
+  std::optional<pinned_thread_pool::scheduler>* busy;
+  std::atomic<bool>* running;
+  std::atomic<bool>* released;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         blocking_receiver&& r) noexcept {
+    r.busy->emplace(execution::get_scheduler(r.pool->get_env()));
+    r.running->store(true);
+    r.running->notify_one();
+    r.released->wait(false);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         blocking_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+struct releasing_receiver {
+  pinned_thread_pool* pool;
+  pinned_thread_pool::scheduler busy;
+  std::atomic<bool>* stolen;
+  std::atomic<bool>* released;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         releasing_receiver&& r) noexcept {
+    auto const current = execution::get_scheduler(r.pool->get_env());
+    r.stolen->store(current != r.busy);
+    r.released->store(true);
+    r.released->notify_all();
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         releasing_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+template <class Receiver>
+using schedule_operation =
+    execution::connect_result_t<execution::schedule_result_t<
+                                    pinned_thread_pool::scheduler>,
+                                Receiver>;
+
+template <class Receiver>
+struct started_operation {
+  schedule_operation<Receiver> op;
+
+  started_operation(pinned_thread_pool::scheduler sched, Receiver r)
+      : op(execution::connect(execution::schedule(sched), std::move(r))) {
+    execution::start(op);
+  }
+};
+
+// Blocks a core of a pool on the given cpus and queues work behind it there.
+// Returns whether another worker ran the queued work while it was blocked.
+auto run_behind_busy_core(std::vector<std::size_t> const& cpus,
+                          execution::cpu_topology const& topology) -> bool {
+  std::optional<pinned_thread_pool::scheduler> busy;
+  std::atomic<bool> running{false};
+  std::atomic<bool> released{false};
+  std::atomic<bool> stolen{false};
+  std::deque<started_operation<blocking_receiver>> blockers;
+  std::deque<started_operation<releasing_receiver>> queued;
+  pinned_thread_pool pool{cpus, topology};
+
+  blockers.emplace_back(pool.get_scheduler_on(0),
+                        blocking_receiver{&pool, &busy, &running, &released});
+  running.wait(false);
+  queued.emplace_back(*busy,
+                      releasing_receiver{&pool, *busy, &stolen, &released});
+  released.wait(false);
+  return stolen.load();
+}
+
+}  // namespace
+
+TEST_CASE("static type checks") {
+  static_assert(execution::scheduler<pinned_thread_pool::scheduler>);
+  static_assert(execution::receiver<counting_receiver>);
+  static_assert(
+      execution::operation_state<schedule_operation<counting_receiver>>);
+}
+
+TEST_CASE("cpu list parsing") {
+  REQUIRE(execution::parse_cpu_list("0-3,8,10-11\n") ==
+          std::vector<std::size_t>{0, 1, 2, 3, 8, 10, 11});
+  REQUIRE(execution::parse_cpu_list("5") == std::vector<std::size_t>{5});
+  REQUIRE(execution::parse_cpu_list("").empty());
+  REQUIRE(execution::parse_cpu_list("x,3-1,2") ==
+          std::vector<std::size_t>{2});
+}
+
+TEST_CASE("topology maps cpus to nodes") {
+  execution::cpu_topology topology{{{0, 1}, {2, 3}}};
+  REQUIRE(topology.node_count() == 2);
+  REQUIRE(topology.node_of(1) == 0);
+  REQUIRE(topology.node_of(3) == 1);
+  REQUIRE(topology.node_of(42) == 0);
+
+  auto const detected = execution::cpu_topology::detect();
+  REQUIRE(detected.node_count() >= 1);
+}
+
+TEST_CASE("all scheduled work runs") {
+  std::atomic<int> count{0};
+  std::deque<started_operation<counting_receiver>> ops;
+  {
+    pinned_thread_pool pool{{0, 0, 0}};
+    REQUIRE(pool.size() == 3);
+    for (std::size_t i = 0; i < 100; ++i) {
+      ops.emplace_back(i % 2 == 0 ? pool.get_scheduler()
+                                  : pool.get_scheduler_on(i % pool.size()),
+                       counting_receiver{&count});
+    }
+  }
+  REQUIRE(count == 100);
+}
+
+TEST_CASE("current scheduler is the core of the running worker") {
+  pinned_thread_pool pool{{0}};
+  REQUIRE(execution::get_scheduler(pool.get_env()) == pool.get_scheduler());
+
+  std::atomic<bool> on_expected_core{false};
+  auto sched = pool.get_scheduler_on(0);
+  auto op = execution::connect(execution::schedule(sched),
+                               core_receiver{&pool, &on_expected_core, sched});
+  execution::start(op);
+  while (!on_expected_core.load()) {
+    std::this_thread::yield();
+  }
+}
+
+TEST_CASE("workers on a single node degrade gracefully") {
+  pinned_thread_pool pool{{0, 1}, execution::cpu_topology{{{0, 1}}}};
+  REQUIRE(pool.node_of(0) == 0);
+  REQUIRE(pool.node_of(1) == 0);
+  REQUIRE(pool.cpu_of(1) == 1);
+}
+
+TEST_CASE("a busy core's queued work is run by a same-node sibling") {
+  // Repeated to catch a sibling that goes to sleep just as work is queued.
+  for (int i = 0; i < 200; ++i) {
+    REQUIRE(run_behind_busy_core({0, 0}, execution::cpu_topology{{{0}}}));
+  }
+}
+
+TEST_CASE("a busy core's queued work is run by a remote worker") {
+  for (int i = 0; i < 200; ++i) {
+    REQUIRE(
+        run_behind_busy_core({0, 1}, execution::cpu_topology{{{0}, {1}}}));
+  }
+}
+
+TEST_CASE("workers steal from their own node before remote ones") {
+  pinned_thread_pool pool{{0, 2, 1, 3},
+                          execution::cpu_topology{{{0, 1}, {2, 3}}}};
+  REQUIRE(pool.steal_order(0) == std::vector<std::size_t>{2, 1, 3});
+  REQUIRE(pool.steal_order(1) == std::vector<std::size_t>{3, 0, 2});
+  REQUIRE(pool.steal_order(2) == std::vector<std::size_t>{0, 1, 3});
+  REQUIRE(pool.steal_order(3) == std::vector<std::size_t>{1, 0, 2});
+}
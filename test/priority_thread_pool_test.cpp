@@ -0,0 +1,236 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include "gate.hpp"
+#include "logging_receiver.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <get_stop_token.hpp>
+#include <in_place_stop_token.hpp>
+#include <priority_thread_pool.hpp>
+#include <then.hpp>
+#include <tracing.hpp>
+#include <vector>
+
+using execution::priority;
+using execution::priority_thread_pool;
+
+namespace {
+
+struct stoppable_env {
+  execution::in_place_stop_token token;
+  execution::tracer* tracer;
+
+  friend auto tag_invoke(
+      functional::tag_t<execution::get_stop_token> /*unused*/,
+      stoppable_env const& env) noexcept -> execution::in_place_stop_token {
+    return env.token;
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_tracer> /*unused*/,
+                         stoppable_env const& env) noexcept
+      -> execution::tracer& {
+    return *env.tracer;
+  }
+};
+
+// Counts how often work ran and how often it was stopped instead.
+struct stoppable_receiver {
+  std::atomic<int>* values;
+  std::atomic<int>* stops;
+  stoppable_env env;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         stoppable_receiver&& r) noexcept {
+    r.values->fetch_add(1);
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_stopped> /*unused*/,
+                         stoppable_receiver&& r) noexcept {
+    r.stops->fetch_add(1);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         stoppable_receiver const& r) noexcept
+      -> stoppable_env {
+    return r.env;
+  }
+};
+
+template <class Sender, class Receiver = logging_receiver>
+struct started {
+  execution::connect_result_t<Sender, Receiver> op;
+
+  started(Sender sender, Receiver receiver)
+      : op(execution::connect(std::move(sender), std::move(receiver))) {
+    execution::start(op);
+  }
+};
+
+using schedule_sender =
+    execution::schedule_result_t<priority_thread_pool::scheduler>;
+
+}  // namespace
+
+TEST_CASE("static type checks") {
+  static_assert(execution::scheduler<priority_thread_pool::scheduler>);
+  static_assert(execution::forwarding_query<
+                functional::tag_t<execution::get_priority>>);
+}
+
+TEST_CASE("all scheduled work runs") {
+  execution_log log;
+  std::deque<started<schedule_sender>> ops;
+  {
+    priority_thread_pool pool{4};
+    for (std::size_t i = 0; i < 300; ++i) {
+      auto const prio = static_cast<priority>(i % 3);
+      ops.emplace_back(execution::schedule(pool.get_scheduler()),
+                       logging_receiver{&log, i, {prio}});
+    }
+  }
+  REQUIRE(log.order.size() == 300);
+}
+
+TEST_CASE("higher priority runs first") {
+  execution_log log;
+  std::deque<started<schedule_sender>> ops;
+  {
+    priority_thread_pool pool{1, 1000};
+    gate g{pool.get_scheduler()};
+    for (int i = 0; i < 5; ++i) {
+      ops.emplace_back(execution::schedule(pool.get_scheduler()),
+                       logging_receiver{&log, 0, {priority::low}});
+    }
+    for (int i = 0; i < 5; ++i) {
+      ops.emplace_back(execution::schedule(pool.get_scheduler()),
+                       logging_receiver{&log, 1, {priority::high}});
+    }
+    g.open.store(true);
+  }
+  REQUIRE(log.order == std::vector<std::size_t>{1, 1, 1, 1, 1, 0, 0, 0, 0, 0});
+}
+
+TEST_CASE("scheduler fallback applies only without an environment priority") {
+  execution_log log;
+  std::deque<started<schedule_sender>> prioritized;
+  std::deque<started<schedule_sender, fallback_receiver>> unprioritized;
+  {
+    priority_thread_pool pool{1, 1000};
+    gate g{pool.get_scheduler()};
+    auto const highFallback = pool.get_scheduler(priority::high);
+    for (int i = 0; i < 3; ++i) {
+      prioritized.emplace_back(execution::schedule(pool.get_scheduler()),
+                               logging_receiver{&log, 0, {priority::normal}});
+    }
+    for (int i = 0; i < 3; ++i) {
+      prioritized.emplace_back(execution::schedule(highFallback),
+                               logging_receiver{&log, 1, {priority::low}});
+    }
+    for (int i = 0; i < 3; ++i) {
+      unprioritized.emplace_back(execution::schedule(highFallback),
+                                 fallback_receiver{&log, 2, {}});
+    }
+    g.open.store(true);
+  }
+  REQUIRE(log.order == std::vector<std::size_t>{2, 2, 2, 0, 0, 0, 1, 1, 1});
+}
+
+TEST_CASE("aging lets low priority through") {
+  execution_log log;
+  std::deque<started<schedule_sender>> ops;
+  {
+    priority_thread_pool pool{1, 2};
+    gate g{pool.get_scheduler()};
+    ops.emplace_back(execution::schedule(pool.get_scheduler()),
+                     logging_receiver{&log, 0, {priority::low}});
+    for (int i = 0; i < 10; ++i) {
+      ops.emplace_back(execution::schedule(pool.get_scheduler()),
+                       logging_receiver{&log, 1, {priority::high}});
+    }
+    g.open.store(true);
+  }
+  REQUIRE(log.order.size() == 11);
+  REQUIRE(log.order[2] == 0);
+}
+
+TEST_CASE("priority is inherited through then") {
+  execution_log log;
+  auto tag = []() noexcept {};
+  using then_sender = decltype(execution::then(std::declval<schedule_sender>(),
+                                               tag));
+  std::deque<started<then_sender>> ops;
+  {
+    priority_thread_pool pool{1, 1000};
+    gate g{pool.get_scheduler()};
+    ops.emplace_back(
+        execution::then(execution::schedule(pool.get_scheduler()), tag),
+        logging_receiver{&log, 0, {priority::low}});
+    ops.emplace_back(
+        execution::then(execution::schedule(pool.get_scheduler()), tag),
+        logging_receiver{&log, 1, {priority::high}});
+    g.open.store(true);
+  }
+  REQUIRE(log.order == std::vector<std::size_t>{1, 0});
+}
+
+TEST_CASE("work stopped while queued completes with set_stopped") {
+  execution::in_place_stop_source stopped;
+  execution::in_place_stop_source running;
+  execution::tracer tracer;
+  std::atomic<int> values{0};
+  std::atomic<int> stops{0};
+  std::deque<started<schedule_sender, stoppable_receiver>> ops;
+  {
+    priority_thread_pool pool{1};
+    gate g{pool.get_scheduler()};
+    ops.emplace_back(
+        execution::schedule(pool.get_scheduler()),
+        stoppable_receiver{&values, &stops, {stopped.get_token(), &tracer}});
+    ops.emplace_back(
+        execution::schedule(pool.get_scheduler()),
+        stoppable_receiver{&values, &stops, {running.get_token(), &tracer}});
+    stopped.request_stop();
+    g.open.store(true);
+  }
+  REQUIRE(values == 1);
+  REQUIRE(stops == 1);
+
+  std::vector<execution::trace_event_kind> kinds;
+  tracer.drain([&](std::uint32_t /*unused*/,
+                   execution::trace_event const& event) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    if (event.operation == reinterpret_cast<std::uintptr_t>(&ops[0].op)) {
+      kinds.push_back(event.kind);
+    }
+  });
+  REQUIRE(kinds == std::vector<execution::trace_event_kind>{
+                       execution::trace_event_kind::started,
+                       execution::trace_event_kind::cancelled});
+}
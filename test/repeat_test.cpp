@@ -0,0 +1,374 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <environment.hpp>
+#include <exception>
+#include <functional>
+#include <get_stop_token.hpp>
+#include <in_place_stop_token.hpp>
+#include <never_stop_token.hpp>
+#include <priority_thread_pool.hpp>
+#include <repeat.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <stdexcept>
+#include <string>
+#include <then.hpp>
+#include <thread>
+#include <tracing.hpp>
+#include <trampoline_scheduler.hpp>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace {
+
+enum class outcome { none, value, error, stopped };
+
+struct stop_env {
+  execution::in_place_stop_token token;
+
+  friend auto tag_invoke(
+      functional::tag_t<execution::get_stop_token> /*unused*/,
+      stop_env const& env) noexcept -> execution::in_place_stop_token {
+    return env.token;
+  }
+};
+
+struct traced_stop_env : stop_env {
+  execution::tracer* tracer;
+
+  friend auto tag_invoke(functional::tag_t<execution::get_tracer> /*unused*/,
+                         traced_stop_env const& env) noexcept
+      -> execution::tracer& {
+    return *env.tracer;
+  }
+};
+
+// Records how the operation completed, and the value if it was an int.
+template <class Env = execution::empty_env>
+struct result_receiver {
+  std::atomic<outcome>* result;
+  int* value = nullptr;
+  Env env{};
+
+  template <class... Values>
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         result_receiver&& r, Values... values) noexcept {
+    if constexpr (sizeof...(Values) == 1) {
+      *r.value = (values, ...);
+    }
+    r.result->store(outcome::value);
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_error> /*unused*/,
+                         result_receiver&& r,
+                         std::exception_ptr /*unused*/) noexcept {
+    r.result->store(outcome::error);
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_stopped> /*unused*/,
+                         result_receiver&& r) noexcept {
+    r.result->store(outcome::stopped);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         result_receiver const& r) noexcept -> Env {
+    return r.env;
+  }
+};
+
+// Fails with an exception until it has been started `failures` times.
+struct flaky_sender {
+  int* attempts;
+  int failures;
+
+  template <class Receiver>
+  struct operation {
+    int* attempts;
+    int failures;
+    Receiver receiver;
+
+    friend void tag_invoke(functional::tag_t<execution::start> /*unused*/,
+                           operation& op) noexcept {
+      if (++*op.attempts <= op.failures) {
+        execution::set_error(
+            std::move(op.receiver),
+            std::make_exception_ptr(std::runtime_error("flaky")));
+      } else {
+        execution::set_value(std::move(op.receiver), *op.attempts);
+      }
+    }
+  };
+
+  template <class Receiver>
+  friend auto tag_invoke(functional::tag_t<execution::connect> /*unused*/,
+                         flaky_sender const& s, Receiver&& r)
+      -> operation<std::remove_cvref_t<Receiver>> {
+    return {s.attempts, s.failures, std::forward<Receiver>(r)};
+  }
+};
+
+// Completes with set_stopped when started.
+struct stopped_sender {
+  template <class Receiver>
+  struct operation {
+    Receiver receiver;
+
+    friend void tag_invoke(functional::tag_t<execution::start> /*unused*/,
+                           operation& op) noexcept {
+      execution::set_stopped(std::move(op.receiver));
+    }
+  };
+
+  template <class Receiver>
+  friend auto tag_invoke(functional::tag_t<execution::connect> /*unused*/,
+                         stopped_sender /*unused*/, Receiver&& r)
+      -> operation<std::remove_cvref_t<Receiver>> {
+    return {std::forward<Receiver>(r)};
+  }
+};
+
+// Destroys the operation it is part of from inside its completion, which
+// receivers are allowed to do.
+struct freeing_receiver {
+  std::atomic<outcome>* result;
+  std::function<void()>* destroy;
+
+  static void complete(freeing_receiver&& r, outcome o) noexcept {
+    auto* result = r.result;  // r dies with the operation.
+    (*r.destroy)();
+    result->store(o);
+  }
+
+  template <class... Values>
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         freeing_receiver&& r,
+                         Values&&... /*unused*/) noexcept {
+    complete(std::move(r), outcome::value);
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_error> /*unused*/,
+                         freeing_receiver&& r,
+                         std::exception_ptr /*unused*/) noexcept {
+    complete(std::move(r), outcome::error);
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_stopped> /*unused*/,
+                         freeing_receiver&& r) noexcept {
+    complete(std::move(r), outcome::stopped);
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         freeing_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+// Starts a heap allocated operation whose receiver deletes it, and waits for
+// the outcome.
+template <class Sender>
+auto run_and_free(Sender sender) -> outcome {
+  std::atomic<outcome> result{outcome::none};
+  std::function<void()> destroy;
+  auto* op = new auto(execution::connect(
+      std::move(sender), freeing_receiver{&result, &destroy}));
+  destroy = [op] { delete op; };
+  execution::start(*op);
+  while (result == outcome::none) {
+    std::this_thread::yield();
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("get_stop_token defaults to never_stop_token") {
+  static_assert(std::is_same_v<execution::stop_token_of_t<execution::empty_env>,
+                               execution::never_stop_token>);
+
+  execution::in_place_stop_source source;
+  stop_env env{source.get_token()};
+  REQUIRE(execution::get_stop_token(env) == source.get_token());
+  REQUIRE(execution::get_stop_token(execution::forward_env(env)) ==
+          source.get_token());
+}
+
+TEST_CASE("repeat_effect_until runs until the predicate holds") {
+  execution::trampoline_scheduler scheduler;
+  int count = 0;
+  std::atomic<outcome> result{outcome::none};
+  auto op = execution::connect(
+      execution::repeat_effect_until(
+          execution::then(execution::schedule(scheduler),
+                          [&count]() noexcept { ++count; }),
+          [&count]() noexcept { return count == 1'000'000; }),
+      result_receiver<>{&result});
+  execution::start(op);
+  REQUIRE(result == outcome::value);
+  REQUIRE(count == 1'000'000);
+}
+
+TEST_CASE("repeat_effect_until runs the effect at least once") {
+  execution::trampoline_scheduler scheduler;
+  int count = 0;
+  std::atomic<outcome> result{outcome::none};
+  auto op = execution::connect(
+      execution::repeat_effect_until(
+          execution::then(execution::schedule(scheduler),
+                          [&count]() noexcept { ++count; }),
+          []() noexcept { return true; }),
+      result_receiver<>{&result});
+  execution::start(op);
+  REQUIRE(result == outcome::value);
+  REQUIRE(count == 1);
+}
+
+TEST_CASE("repeat_effect_until stops when the stop token is triggered") {
+  execution::in_place_stop_source source;
+  execution::trampoline_scheduler scheduler;
+  int count = 0;
+  std::atomic<outcome> result{outcome::none};
+  auto op = execution::connect(
+      execution::repeat_effect_until(
+          execution::then(execution::schedule(scheduler),
+                          [&]() noexcept {
+                            if (++count == 5) {
+                              source.request_stop();
+                            }
+                          }),
+          []() noexcept { return false; }),
+      result_receiver<stop_env>{&result, nullptr, {source.get_token()}});
+  execution::start(op);
+  REQUIRE(result == outcome::stopped);
+  REQUIRE(count == 5);
+}
+
+TEST_CASE("repeat_effect_until traces its cancellation") {
+  execution::in_place_stop_source source;
+  execution::tracer tracer;
+  execution::trampoline_scheduler scheduler;
+  std::atomic<outcome> result{outcome::none};
+  auto op = execution::connect(
+      execution::repeat_effect_until(
+          execution::then(execution::schedule(scheduler),
+                          [&]() noexcept { source.request_stop(); }),
+          []() noexcept { return false; }),
+      result_receiver<traced_stop_env>{
+          &result, nullptr, {{source.get_token()}, &tracer}});
+  execution::start(op);
+  REQUIRE(result == outcome::stopped);
+
+  std::vector<execution::trace_event_kind> kinds;
+  tracer.drain([&](std::uint32_t /*unused*/,
+                   execution::trace_event const& event) {
+    REQUIRE(std::string{event.name} == "repeat_effect_until");
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    REQUIRE(event.operation == reinterpret_cast<std::uintptr_t>(&op));
+    kinds.push_back(event.kind);
+  });
+  REQUIRE(kinds == std::vector<execution::trace_event_kind>{
+                       execution::trace_event_kind::started,
+                       execution::trace_event_kind::cancelled});
+}
+
+TEST_CASE("repeat_effect_until forwards errors") {
+  int attempts = 0;
+  int ignored = 0;
+  std::atomic<outcome> result{outcome::none};
+  auto op = execution::connect(
+      execution::repeat_effect_until(
+          execution::then(flaky_sender{&attempts, 1}, [](int) noexcept {}),
+          []() noexcept { return false; }),
+      result_receiver<>{&result, &ignored});
+  execution::start(op);
+  REQUIRE(result == outcome::error);
+  REQUIRE(attempts == 1);
+}
+
+TEST_CASE("repeat_effect_until continues on the completing thread") {
+  std::atomic<outcome> result{outcome::none};
+  std::atomic<int> count{0};
+  execution::priority_thread_pool pool{2};
+  auto op = execution::connect(
+      execution::repeat_effect_until(
+          execution::then(execution::schedule(pool.get_scheduler()),
+                          [&count]() noexcept { ++count; }),
+          [&count]() noexcept { return count == 1000; }),
+      result_receiver<>{&result});
+  execution::start(op);
+  while (result == outcome::none) {
+    std::this_thread::yield();
+  }
+  REQUIRE(result == outcome::value);
+  REQUIRE(count == 1000);
+}
+
+TEST_CASE("retry repeats until the sender succeeds") {
+  int attempts = 0;
+  int value = 0;
+  std::atomic<outcome> result{outcome::none};
+  auto op = execution::connect(execution::retry(flaky_sender{&attempts, 3}),
+                               result_receiver<>{&result, &value});
+  execution::start(op);
+  REQUIRE(result == outcome::value);
+  REQUIRE(attempts == 4);
+  REQUIRE(value == 4);
+}
+
+TEST_CASE("the final completion may destroy the operation") {
+  execution::trampoline_scheduler scheduler;
+  int attempts = 0;
+  REQUIRE(run_and_free(execution::repeat_effect_until(
+              execution::then(execution::schedule(scheduler), []() noexcept {}),
+              []() noexcept { return true; })) == outcome::value);
+  REQUIRE(run_and_free(execution::repeat_effect_until(
+              execution::then(flaky_sender{&attempts, 1}, [](int) noexcept {}),
+              []() noexcept { return false; })) == outcome::error);
+  REQUIRE(run_and_free(execution::repeat_effect_until(
+              stopped_sender{}, []() noexcept { return false; })) ==
+          outcome::stopped);
+  attempts = 0;
+  REQUIRE(run_and_free(execution::retry(flaky_sender{&attempts, 2})) ==
+          outcome::value);
+  REQUIRE(run_and_free(execution::retry(stopped_sender{})) ==
+          outcome::stopped);
+}
+
+TEST_CASE("the final completion may destroy the operation on another thread") {
+  execution::priority_thread_pool pool{2};
+  for (int i = 0; i < 200; ++i) {
+    std::atomic<int> count{0};
+    REQUIRE(run_and_free(execution::repeat_effect_until(
+                execution::then(execution::schedule(pool.get_scheduler()),
+                                [&count]() noexcept { ++count; }),
+                [&count]() noexcept { return count == 10; })) ==
+            outcome::value);
+  }
+}
@@ -0,0 +1,159 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include "gate.hpp"
+#include "logging_receiver.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <emplace_from.hpp>
+#include <environment.hpp>
+#include <pinned_thread_pool.hpp>
+#include <priority.hpp>
+#include <priority_thread_pool.hpp>
+#include <schedule_bulk.hpp>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <trampoline_scheduler.hpp>
+#include <vector>
+
+using execution::priority;
+
+namespace {
+
+template <class Scheduler>
+using operation_t = execution::connect_result_t<
+    execution::schedule_result_t<Scheduler>, logging_receiver>;
+
+template <class Scheduler>
+auto make_batch(Scheduler sched, std::size_t size, execution_log* log,
+                bool mixedPriorities = false)
+    -> std::deque<operation_t<Scheduler>> {
+  std::deque<operation_t<Scheduler>> ops;
+  for (std::size_t i = 0; i < size; ++i) {
+    auto const prio =
+        mixedPriorities ? static_cast<priority>(i % execution::priority_levels)
+                        : priority::normal;
+    ops.emplace_back(execution::emplace_from{[&] {
+      return execution::connect(execution::schedule(sched),
+                                logging_receiver{log, i, {prio}});
+    }});
+  }
+  return ops;
+}
+
+template <class Scheduler>
+constexpr bool has_batch_path =
+    functional::tag_invocable<execution::_schedule_bulk::schedule_bulk_t,
+                              Scheduler const&,
+                              std::deque<operation_t<Scheduler>>&>;
+
+}  // namespace
+
+TEST_CASE("schedule_bulk starts each operation without a batch path") {
+  static_assert(!has_batch_path<execution::trampoline_scheduler>);
+
+  execution_log log;
+  execution::trampoline_scheduler sched;
+  auto ops = make_batch(sched, 5, &log);
+  execution::schedule_bulk(sched, ops);
+  REQUIRE(log.count == 5);
+  REQUIRE(log.order == std::vector<std::size_t>{0, 1, 2, 3, 4});
+}
+
+TEST_CASE("priority_thread_pool runs a batch in order") {
+  using scheduler = execution::priority_thread_pool::scheduler;
+  static_assert(has_batch_path<scheduler>);
+
+  execution_log log;
+  execution::priority_thread_pool pool{1};
+  auto ops = make_batch(pool.get_scheduler(), 1000, &log);
+  execution::schedule_bulk(pool.get_scheduler(), ops);
+  log.wait_for(1000);
+  REQUIRE(log.order.size() == 1000);
+  for (std::size_t i = 0; i < log.order.size(); ++i) {
+    REQUIRE(log.order[i] == i);
+  }
+}
+
+TEST_CASE("priority_thread_pool splits a batch by priority") {
+  constexpr std::size_t size = 3000;
+  execution_log log;
+  // Aging never kicks in, so every level runs after the ones above it.
+  execution::priority_thread_pool pool{1, 100'000};
+  std::deque<operation_t<execution::priority_thread_pool::scheduler>> ops;
+  {
+    gate g{pool.get_scheduler()};
+    ops = make_batch(pool.get_scheduler(), size, &log, true);
+    execution::schedule_bulk(pool.get_scheduler(), ops);
+  }
+  log.wait_for(size);
+  REQUIRE(log.order.size() == size);
+  for (std::size_t i = 0; i < size; ++i) {
+    // Ids cycle through high, normal and low, and a third of them is each.
+    REQUIRE(log.order[i] % execution::priority_levels == i / (size / 3));
+  }
+}
+
+TEST_CASE("pinned_thread_pool runs batches on one or all cores") {
+  using scheduler = execution::pinned_thread_pool::scheduler;
+  static_assert(has_batch_path<scheduler>);
+
+  execution_log log;
+  execution::pinned_thread_pool pool{{0, 0, 0}};
+  auto spread = make_batch(pool.get_scheduler(), 1000, &log);
+  auto single = make_batch(pool.get_scheduler_on(1), 1000, &log);
+  execution::schedule_bulk(pool.get_scheduler(), spread);
+  execution::schedule_bulk(pool.get_scheduler_on(1), single);
+  log.wait_for(2000);
+}
+
+TEST_CASE("schedule_bulk runs operations on the pool they came from") {
+  execution_log log;
+  execution::priority_thread_pool pool{1};
+  execution::priority_thread_pool other{1};
+  execution::pinned_thread_pool pinned{{0}};
+  execution::pinned_thread_pool otherPinned{{0}};
+  auto ops = make_batch(pool.get_scheduler(), 100, &log);
+  auto pinnedOps = make_batch(pinned.get_scheduler_on(0), 100, &log);
+  // The other pools are blocked, so they cannot run the batches.
+  gate g{other.get_scheduler()};
+  gate pinnedGate{otherPinned.get_scheduler_on(0)};
+  execution::schedule_bulk(other.get_scheduler(), ops);
+  execution::schedule_bulk(otherPinned.get_scheduler_on(0), pinnedOps);
+  log.wait_for(200);
+}
+
+TEST_CASE("schedule_bulk accepts an empty batch") {
+  execution_log log;
+  execution::priority_thread_pool pool{1};
+  execution::pinned_thread_pool pinned{{0}};
+  std::deque<operation_t<execution::priority_thread_pool::scheduler>> ops;
+  std::deque<operation_t<execution::pinned_thread_pool::scheduler>> pinned_ops;
+  execution::schedule_bulk(pool.get_scheduler(), ops);
+  execution::schedule_bulk(pinned.get_scheduler(), pinned_ops);
+  REQUIRE(log.count == 0);
+}
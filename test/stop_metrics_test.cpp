@@ -0,0 +1,120 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define EXECUTION_ENABLE_STOP_METRICS 1
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <in_place_stop_token.hpp>
+#include <optional>
+#include <stop_metrics.hpp>
+#include <thread>
+
+using execution::in_place_stop_callback;
+using execution::in_place_stop_source;
+using execution::stop_metrics;
+
+namespace {
+
+struct noop {
+  void operator()() const noexcept {}
+};
+
+}  // namespace
+
+TEST_CASE("static type checks") { static_assert(stop_metrics::enabled); }
+
+TEST_CASE("callbacks registered and executed are counted") {
+  stop_metrics::reset();
+  {
+    in_place_stop_source source;
+    in_place_stop_callback<noop> cb1{source.get_token(), noop{}};
+    in_place_stop_callback<noop> cb2{source.get_token(), noop{}};
+    REQUIRE_FALSE(source.request_stop());
+    REQUIRE(source.request_stop());
+    in_place_stop_callback<noop> cb3{source.get_token(), noop{}};
+  }
+  auto const snapshot = stop_metrics::snapshot();
+  REQUIRE(snapshot.callbacks_registered == 2);
+  REQUIRE(snapshot.callbacks_executed == 3);
+  REQUIRE(snapshot.stop_requests == 2);
+  REQUIRE(snapshot.request_stop_ns > 0);
+  REQUIRE(snapshot.lock_acquisitions >= 4);
+  REQUIRE(snapshot.remove_callback_waits == 0);
+}
+
+TEST_CASE("time blocked in remove_callback is measured") {
+  stop_metrics::reset();
+  in_place_stop_source source;
+  std::atomic<bool> started{false};
+  auto slow = [&]() noexcept {
+    started.store(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  };
+  std::optional<in_place_stop_callback<decltype(slow)>> cb;
+  cb.emplace(source.get_token(), slow);
+  std::thread stopper{[&] { source.request_stop(); }};
+  while (!started.load()) {
+    std::this_thread::yield();
+  }
+  cb.reset();
+  stopper.join();
+
+  auto const snapshot = stop_metrics::snapshot();
+  REQUIRE(snapshot.remove_callback_waits == 1);
+  REQUIRE(snapshot.remove_callback_wait_ns > 0);
+  REQUIRE(snapshot.spin_iterations + snapshot.spin_yields > 0);
+}
+
+TEST_CASE("batched request_stop takes the lock once per batch") {
+  constexpr std::size_t count = 10000;
+  for (std::size_t batchSize : {std::size_t{64}, std::size_t{1024}}) {
+    in_place_stop_source source;
+    std::deque<in_place_stop_callback<noop>> callbacks;
+    for (std::size_t i = 0; i < count; ++i) {
+      callbacks.emplace_back(source.get_token(), noop{});
+    }
+    stop_metrics::reset();
+    REQUIRE_FALSE(source.request_stop(
+        execution::in_place_stop_batching{batchSize, 1}));
+    auto const snapshot = stop_metrics::snapshot();
+    REQUIRE(snapshot.callbacks_executed == count);
+    // One lock for stop itself, one per batch and one to see the list empty.
+    REQUIRE(snapshot.lock_acquisitions ==
+            2 + (count + batchSize - 1) / batchSize);
+  }
+}
+
+TEST_CASE("reset clears counters") {
+  in_place_stop_source source;
+  source.request_stop();
+  stop_metrics::reset();
+  auto const snapshot = stop_metrics::snapshot();
+  REQUIRE(snapshot.stop_requests == 0);
+  REQUIRE(snapshot.lock_acquisitions == 0);
+}
@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include <exception>
+#include <optional>
+#include <priority.hpp>
+#include <stdexcept>
+#include <then.hpp>
+#include <tracing.hpp>
+#include <utility>
+
+namespace {
+
+// Completes inline with the given value when started.
+template <class T>
+struct just_sender {
+  T value;
+
+  template <class Receiver>
+  struct operation {
+    T value;
+    Receiver receiver;
+
+    friend void tag_invoke(functional::tag_t<execution::start> /*unused*/,
+                           operation& op) noexcept {
+      execution::set_value(std::move(op.receiver), std::move(op.value));
+    }
+  };
+
+  template <class Receiver>
+  friend auto tag_invoke(functional::tag_t<execution::connect> /*unused*/,
+                         just_sender s, Receiver&& r)
+      -> operation<std::remove_cvref_t<Receiver>> {
+    return {std::move(s.value), std::forward<Receiver>(r)};
+  }
+};
+
+struct custom_query_t {
+  template <class Env>
+  requires functional::tag_invocable<custom_query_t, Env const&>
+  auto operator()(Env const& env) const noexcept -> int {
+    return tag_invoke(*this, env);
+  }
+};
+inline constexpr custom_query_t custom_query{};
+
+struct test_env {
+  friend auto tag_invoke(functional::tag_t<execution::get_priority> /*unused*/,
+                         test_env const& /*unused*/) noexcept
+      -> execution::priority {
+    return execution::priority::high;
+  }
+
+  friend auto tag_invoke(custom_query_t /*unused*/,
+                         test_env const& /*unused*/) noexcept -> int {
+    return 1;
+  }
+};
+
+struct int_receiver {
+  std::optional<int>* value;
+  bool* error;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         int_receiver&& r, int v) noexcept {
+    *r.value = v;
+  }
+
+  friend void tag_invoke(functional::tag_t<execution::set_error> /*unused*/,
+                         int_receiver&& r,
+                         std::exception_ptr /*unused*/) noexcept {
+    *r.error = true;
+  }
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         int_receiver const& /*unused*/) noexcept -> test_env {
+    return {};
+  }
+};
+
+}  // namespace
+
+TEST_CASE("then transforms the value") {
+  std::optional<int> value;
+  bool error = false;
+  auto op = execution::connect(
+      execution::then(just_sender<int>{20}, [](int x) { return x + 1; }),
+      int_receiver{&value, &error});
+  execution::start(op);
+  REQUIRE(value == 21);
+  REQUIRE_FALSE(error);
+}
+
+TEST_CASE("then forwards exceptions to set_error") {
+  std::optional<int> value;
+  bool error = false;
+  auto op = execution::connect(
+      execution::then(just_sender<int>{1},
+                      [](int) -> int { throw std::runtime_error{"error"}; }),
+      int_receiver{&value, &error});
+  execution::start(op);
+  REQUIRE_FALSE(value.has_value());
+  REQUIRE(error);
+}
+
+TEST_CASE("then forwards only forwarding queries") {
+  using env_t = execution::forwarding_env<test_env>;
+  static_assert(execution::forwarding_query<
+                functional::tag_t<execution::get_priority>>);
+  static_assert(!execution::forwarding_query<custom_query_t>);
+  static_assert(!functional::tag_invocable<custom_query_t, env_t const&>);
+  static_assert(!execution::tracing_env<env_t>);
+
+  auto const env = execution::forward_env(test_env{});
+  REQUIRE(execution::get_priority(env) == execution::priority::high);
+  REQUIRE(custom_query(test_env{}) == 1);
+}
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tracing.hpp>
+#include <vector>
+
+namespace {
+
+struct traced_env {
+  execution::tracer* tracer_;
+
+  friend auto tag_invoke(functional::tag_t<execution::get_tracer> /*unused*/,
+                         traced_env const& env) noexcept
+      -> execution::tracer& {
+    return *env.tracer_;
+  }
+};
+
+struct plain_env {};
+
+}  // namespace
+
+TEST_CASE("static type checks") {
+  static_assert(execution::tracing_env<traced_env>);
+  static_assert(!execution::tracing_env<plain_env>);
+}
+
+TEST_CASE("get_tracer is a forwarding query") {
+  REQUIRE(execution::forwarding_env_query(execution::get_tracer));
+}
+
+TEST_CASE("events are recorded per thread") {
+  execution::tracer tracer;
+  traced_env env{&tracer};
+  int op1 = 0;
+  int op2 = 0;
+  execution::trace(env, execution::trace_event_kind::started, "op1", &op1);
+  std::thread worker{[&] {
+    execution::trace(env, execution::trace_event_kind::started, "op2", &op2);
+    execution::trace(env, execution::trace_event_kind::cancelled, "op2", &op2);
+  }};
+  worker.join();
+  execution::trace(env, execution::trace_event_kind::completed, "op1", &op1);
+  execution::trace(plain_env{}, execution::trace_event_kind::started, "op3",
+                   &op1);
+
+  std::vector<std::pair<std::uint32_t, execution::trace_event>> events;
+  tracer.drain([&](std::uint32_t thread, execution::trace_event const& e) {
+    events.emplace_back(thread, e);
+  });
+  REQUIRE(events.size() == 4);
+  REQUIRE(events[0].first == 0);
+  REQUIRE(events[0].second.kind == execution::trace_event_kind::started);
+  REQUIRE(events[1].second.kind == execution::trace_event_kind::completed);
+  REQUIRE(events[1].second.timestamp_ns >= events[0].second.timestamp_ns);
+  REQUIRE(events[2].first == 1);
+  REQUIRE(events[3].second.kind == execution::trace_event_kind::cancelled);
+  REQUIRE(std::string{events[3].second.name} == "op2");
+
+  std::size_t remaining = 0;
+  tracer.drain([&](std::uint32_t /*unused*/,
+                   execution::trace_event const& /*unused*/) { ++remaining; });
+  REQUIRE(remaining == 0);
+}
+
+TEST_CASE("full ring buffer drops events") {
+  execution::trace_ring_buffer<4> buffer;
+  for (int i = 0; i < 6; ++i) {
+    (void)buffer.try_push(execution::trace_event{});
+  }
+  REQUIRE(buffer.dropped() == 2);
+  REQUIRE(buffer.consume([](execution::trace_event const& /*unused*/) {}) ==
+          4);
+  REQUIRE(buffer.try_push(execution::trace_event{}));
+}
+
+TEST_CASE("chrome trace export") {
+  execution::tracer tracer;
+  int op = 0;
+  tracer.record(execution::trace_event_kind::started, "schedule", &op);
+  tracer.record(execution::trace_event_kind::cancelled, "schedule", &op);
+  std::ostringstream os;
+  execution::write_chrome_trace(tracer, os);
+  auto const json = os.str();
+  REQUIRE(json.starts_with(R"({"displayTimeUnit":"ns","traceEvents":[{)"));
+  REQUIRE(json.find(R"("name":"schedule")") != std::string::npos);
+  REQUIRE(json.find(R"("ph":"b")") != std::string::npos);
+  REQUIRE(json.find(R"("ph":"e")") != std::string::npos);
+  REQUIRE(json.find(R"("result":"cancel")") != std::string::npos);
+  REQUIRE(json.ends_with("]}\n"));
+}
+
+TEST_CASE("alternating between tracers keeps one buffer per thread") {
+  std::array<execution::tracer, 3> tracers;
+  int op = 0;
+  for (int i = 0; i < 100; ++i) {
+    for (auto& tracer : tracers) {
+      tracer.record(execution::trace_event_kind::started, "op", &op);
+    }
+  }
+  for (auto& tracer : tracers) {
+    std::size_t count = 0;
+    tracer.drain([&](std::uint32_t thread,
+                     execution::trace_event const& /*unused*/) {
+      REQUIRE(thread == 0);
+      ++count;
+    });
+    REQUIRE(count == 100);
+  }
+}
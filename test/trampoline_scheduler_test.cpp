@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2022 Rishabh Dwivedi<rishabhdwivedi17@gmail.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <emplace_from.hpp>
+#include <environment.hpp>
+#include <optional>
+#include <scheduler.hpp>
+#include <sender.hpp>
+#include <trampoline_scheduler.hpp>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using execution::trampoline_scheduler;
+
+struct chain;
+
+struct chain_receiver {
+  chain* c;
+
+  friend void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                         chain_receiver&& r) noexcept;
+
+  friend auto tag_invoke(functional::tag_t<execution::get_env> /*unused*/,
+                         chain_receiver const& /*unused*/) noexcept
+      -> execution::empty_env {
+    return {};
+  }
+};
+
+using schedule_operation = execution::connect_result_t<
+    execution::schedule_result_t<trampoline_scheduler>, chain_receiver>;
+
+// Reschedules itself from inside each completion, which recurses through
+// start() unless the scheduler bounces it. depth counts the completions
+// currently on the stack.
+struct chain {
+  explicit chain(trampoline_scheduler s) noexcept : scheduler(s) {}
+
+  trampoline_scheduler scheduler;
+  std::size_t remaining = 0;
+  std::size_t depth = 0;
+  std::size_t maxDepth = 0;
+  std::vector<std::size_t> order;
+  std::optional<schedule_operation> ops[3];
+  std::size_t next = 0;
+
+  void step();
+};
+
+void tag_invoke(functional::tag_t<execution::set_value> /*unused*/,
+                chain_receiver&& r) noexcept {
+  auto* c = r.c;  // r dies when its slot is reused.
+  c->maxDepth = std::max(c->maxDepth, ++c->depth);
+  c->order.push_back(c->remaining);
+  if (c->remaining > 0) {
+    --c->remaining;
+    c->step();
+  }
+  --c->depth;
+}
+
+void chain::step() {
+  auto& op = ops[next++ % 3];
+  op.reset();
+  op.emplace(execution::emplace_from{[this] {
+    return execution::connect(execution::schedule(scheduler),
+                              chain_receiver{this});
+  }});
+  execution::start(*op);
+}
+
+}  // namespace
+
+TEST_CASE("trampoline_scheduler runs the first operation inline") {
+  chain c(trampoline_scheduler{4});
+  c.step();
+  CHECK(c.order == std::vector<std::size_t>{0});
+}
+
+TEST_CASE("trampoline_scheduler bounds the recursion depth") {
+  chain c(trampoline_scheduler{4});
+  c.remaining = 100;
+  c.step();
+  CHECK(c.maxDepth == 4);
+  REQUIRE(c.order.size() == 101);
+  for (std::size_t i = 0; i < c.order.size(); ++i) {
+    CHECK(c.order[i] == 100 - i);
+  }
+}
+
+TEST_CASE("trampoline_scheduler does not overflow the stack") {
+  chain c(trampoline_scheduler{});
+  c.remaining = 1'000'000;
+  c.step();
+  CHECK(c.maxDepth == trampoline_scheduler::default_max_depth);
+  CHECK(c.order.size() == 1'000'001);
+}
+
+TEST_CASE("trampoline_schedulers compare by depth") {
+  CHECK(trampoline_scheduler{} == trampoline_scheduler{});
+  CHECK(trampoline_scheduler{2} != trampoline_scheduler{3});
+}